@@ -9,6 +9,7 @@
 #ifndef WORD2VEC_MAPPER_H
 #define WORD2VEC_MAPPER_H
 
+#include <cstdint>
 #include <string>
 
 namespace w2v {
@@ -77,6 +78,32 @@ namespace w2v {
         fileMapper_t(const fileMapper_t &) = delete;
         void operator=(const fileMapper_t &) = delete;
     };
+
+    /**
+     * @brief reader of a stream (pipe, standard input) into memory
+     *
+     * A stream can be read only once, so it is read into memory as a whole and then it is accessed like a mapped file.
+     * The stream size is limited, a larger train data must be a file which is mapped instead of being copied.
+    */
+    class streamMapper_t final: public mapper_t {
+    private:
+        std::string m_buffer; // stream data
+
+    public:
+        /**
+         * Constructs a streamMapper object reading the stream until its end
+         * @param _fd file descriptor of the stream, it is not closed
+         * @param _name stream name used in error messages
+         * @param _maxSize max stream size in bytes
+         * @throws std::runtime_error In case of failed read operations, an empty stream or a stream larger than
+         * _maxSize
+        */
+        streamMapper_t(int _fd, const std::string &_name, uint64_t _maxSize);
+
+        // copying prohibited
+        streamMapper_t(const streamMapper_t &) = delete;
+        void operator=(const streamMapper_t &) = delete;
+    };
 }
 
 #endif //WORD2VEC_MAPPER_H
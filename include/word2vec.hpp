@@ -20,11 +20,21 @@
 #include <stdexcept>
 
 namespace w2v {
+    class trainMatrix_t;
+
+    /// storage format of the training matrices, computations are always done with 32-bit floats
+    enum class matrixPrecision_t: uint8_t {
+        FP32 = 0, ///< 32-bit floats
+        BF16, ///< bfloat16 - 8-bit exponent, 7-bit mantissa
+        FP16 ///< IEEE 754 half precision - 5-bit exponent, 10-bit mantissa
+    };
+
     /**
      * @brief trainSettings structure holds all training parameters
      */
     struct trainSettings_t final {
         uint16_t minWordFreq = 5; ///< discard words that appear less than minWordFreq times
+        std::size_t maxDistinctWords = 0; ///< prune rare words if a counting thread has more, 0 - no limit
         uint16_t size = 100; ///< word vector size
         uint8_t window = 5; ///< skip length between words
         uint16_t expTableSize = 1000; ///< exp(x) / (exp(x) + 1) values lookup table size
@@ -36,6 +46,21 @@ namespace w2v {
         uint8_t iterations = 5; ///< train iterations
         float alpha = 0.05f; ///< starting learn rate
         bool withSG = false; ///< use Skip-Gram instead of CBOW
+        bool withBatchedSG = false; ///< Skip-Gram/NS: share negative examples within a window, train it as matrices
+        uint64_t seed = 0; ///< random generators seed, 0 - nondeterministic seed
+        matrixPrecision_t precision = matrixPrecision_t::FP32; ///< training matrices storage format
+        std::vector<uint16_t> cpuAffinity; ///< i-th train thread runs on cpuAffinity[i % size], empty - not pinned
+        bool numaInterleave = false; ///< interleave matrices over NUMA nodes instead of the first-touch placement
+        bool hugePages = true; ///< allocate training matrices on huge pages if the system provides them
+        std::size_t hotRows = 0; ///< thread private copies of the most used output rows, 0 - disabled
+        bool hotInputRows = false; ///< keep private copies of the most frequent words input rows as well
+        std::size_t hotRowsSyncWords = 1000; ///< words processed by a thread between merges of its private rows
+        uint8_t prefetchDistance = 2; ///< matrix rows are prefetched for words this far ahead, 0 - disabled
+        /// training state is saved to this file periodically and at the end of training, empty - no checkpoints
+        std::string checkpointFile;
+        uint32_t checkpointInterval = 1800; ///< seconds between checkpoints, 0 - only the final state is saved
+        std::string corpusCacheFile; ///< pre-tokenized corpus cache file, reused if valid, empty - no cache
+        uint8_t decompressionThreads = 4; ///< threads decoding gzip compressed train data files
         std::string wordDelimiterChars = " \n,.-!?:;/\"#$%&'()*+<=>@[]\\^_`{|}~\t\v\f\r";
         std::string endOfSentenceChars = ".\n?!";
         trainSettings_t() = default;
@@ -252,15 +277,37 @@ namespace w2v {
         using vocabularyStatsCallback_t = std::function<void(std::size_t, std::size_t, std::size_t)>;
         /// type of callback function to be called on training progress events
         using trainProgressCallback_t = std::function<void(float, float)>;
+        /**
+         * type of callback function to be called for each NUMA node once training matrices are initialized,
+         * parameters are node ID, number of train threads pinned to the node CPUs and matrices pages on the node
+        */
+        using numaStatsCallback_t = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+    private:
+        std::size_t m_prunedWords = 0;
+
+        /**
+         * fills the model with rows of the trained matrix, i-th row is the vector of i-th word. Words are moved to
+         * the model, the matrix memory is freed while its rows are copied.
+        */
+        void assign(std::vector<std::string> &_words, trainMatrix_t &_trainMatrix,
+                    const trainSettings_t &_trainSettings);
 
     public:
         /// Constructs w2vModel object
         w2vModel_t(): model_t<std::string>() {}
 
+        /**
+         * @returns words pruned from the vocabulary while counting (see trainSettings_t::maxDistinctWords) by the
+         * last training, it is set before the vocabulary statistic callback is called
+        */
+        inline std::size_t prunedWords() const noexcept {return m_prunedWords;}
+
         /**
          * Trains model
          * @param _trainSettings trainSettings_t structure with training parameters
-         * @param _trainFile file name of train corpus data
+         * @param _trainFiles train corpus data - file names, directory names (their files are read recursively)
+         * or "-" for the standard input
          * @param _stopWordsFile file name with stop words
          * @param _vocabularyProgressCallback callback function reporting train corpus data parsing progress,
          * nullptr if progress statistic is not needed
@@ -268,14 +315,104 @@ namespace w2v {
          * nullptr if train data corpus statistic is not needed
          * @param _trainProgressCallback callback function reporting training progress,
          * nullptr if training progress statistic is not needed
+         * @param _numaStatsCallback callback function reporting placement of train threads and matrices on NUMA
+         * nodes, nullptr if NUMA statistic is not needed
          * @returns true on successful completion or false otherwise
         */
         bool train(const trainSettings_t &_trainSettings,
-                   const std::string &_trainFile,
+                   const std::vector<std::string> &_trainFiles,
                    const std::string &_stopWordsFile,
                    vocabularyProgressCallback_t _vocabularyProgressCallback,
                    vocabularyStatsCallback_t _vocabularyStatsCallback,
-                   trainProgressCallback_t _trainProgressCallback) noexcept;
+                   trainProgressCallback_t _trainProgressCallback,
+                   numaStatsCallback_t _numaStatsCallback = nullptr) noexcept;
+
+        /// Trains model from one file, directory or the standard input ("-"), see train() above
+        inline bool train(const trainSettings_t &_trainSettings,
+                          const std::string &_trainFile,
+                          const std::string &_stopWordsFile,
+                          vocabularyProgressCallback_t _vocabularyProgressCallback,
+                          vocabularyStatsCallback_t _vocabularyStatsCallback,
+                          trainProgressCallback_t _trainProgressCallback,
+                          numaStatsCallback_t _numaStatsCallback = nullptr) noexcept {
+            return train(_trainSettings, std::vector<std::string>(1, _trainFile), _stopWordsFile,
+                         _vocabularyProgressCallback, _vocabularyStatsCallback, _trainProgressCallback,
+                         _numaStatsCallback);
+        }
+
+        /**
+         * Resumes an interrupted training from its checkpoint (see trainSettings_t::checkpointFile)
+         * @param _trainSettings trainSettings_t structure with runtime parameters - threads, CPU affinity, memory
+         * placement, thread private rows, prefetching and checkpoints, model parameters are restored from the
+         * checkpoint
+         * @param _trainFiles train corpus data - file names, directory names (their files are read recursively)
+         * or "-" for the standard input,
+         * the same data in the same order the checkpointed training used
+         * @param _checkpointFile checkpoint file name
+         * @param _trainProgressCallback callback function reporting training progress,
+         * nullptr if training progress statistic is not needed
+         * @param _numaStatsCallback callback function reporting placement of train threads and matrices on NUMA
+         * nodes, nullptr if NUMA statistic is not needed
+         * @returns true on successful completion or false otherwise
+        */
+        bool resume(const trainSettings_t &_trainSettings,
+                    const std::vector<std::string> &_trainFiles,
+                    const std::string &_checkpointFile,
+                    trainProgressCallback_t _trainProgressCallback,
+                    numaStatsCallback_t _numaStatsCallback = nullptr) noexcept;
+
+        /// Resumes an interrupted training of one file, directory or the standard input ("-"), see resume() above
+        inline bool resume(const trainSettings_t &_trainSettings,
+                           const std::string &_trainFile,
+                           const std::string &_checkpointFile,
+                           trainProgressCallback_t _trainProgressCallback,
+                           numaStatsCallback_t _numaStatsCallback = nullptr) noexcept {
+            return resume(_trainSettings, std::vector<std::string>(1, _trainFile), _checkpointFile,
+                          _trainProgressCallback, _numaStatsCallback);
+        }
+
+        /**
+         * Updates a trained model with new train data. Words of the model are extended with new words of the train
+         * data, rows of the model words are initialized with their trained values, rows of the new words are
+         * initialized as usual. Only the new train data is trained.
+         * @param _trainSettings trainSettings_t structure with training parameters, the vector size, the matrices
+         * storage format and the approximation method are restored from the trained model
+         * @param _trainFiles new train corpus data - file names, directory names (their files are read recursively)
+         * or "-" for the standard input
+         * @param _stopWordsFile file name with stop words
+         * @param _baseFile final training state of the trained model, see trainSettings_t::checkpointFile
+         * @param _vocabularyProgressCallback callback function reporting train corpus data parsing progress,
+         * nullptr if progress statistic is not needed
+         * @param _vocabularyStatsCallback callback function reporting statistic of the extended vocabulary and the
+         * new train data, nullptr if train data corpus statistic is not needed
+         * @param _trainProgressCallback callback function reporting training progress,
+         * nullptr if training progress statistic is not needed
+         * @param _numaStatsCallback callback function reporting placement of train threads and matrices on NUMA
+         * nodes, nullptr if NUMA statistic is not needed
+         * @returns true on successful completion or false otherwise
+        */
+        bool update(const trainSettings_t &_trainSettings,
+                    const std::vector<std::string> &_trainFiles,
+                    const std::string &_stopWordsFile,
+                    const std::string &_baseFile,
+                    vocabularyProgressCallback_t _vocabularyProgressCallback,
+                    vocabularyStatsCallback_t _vocabularyStatsCallback,
+                    trainProgressCallback_t _trainProgressCallback,
+                    numaStatsCallback_t _numaStatsCallback = nullptr) noexcept;
+
+        /// Updates a trained model with one file, directory or the standard input ("-"), see update() above
+        inline bool update(const trainSettings_t &_trainSettings,
+                           const std::string &_trainFile,
+                           const std::string &_stopWordsFile,
+                           const std::string &_baseFile,
+                           vocabularyProgressCallback_t _vocabularyProgressCallback,
+                           vocabularyStatsCallback_t _vocabularyStatsCallback,
+                           trainProgressCallback_t _trainProgressCallback,
+                           numaStatsCallback_t _numaStatsCallback = nullptr) noexcept {
+            return update(_trainSettings, std::vector<std::string>(1, _trainFile), _stopWordsFile, _baseFile,
+                          _vocabularyProgressCallback, _vocabularyStatsCallback, _trainProgressCallback,
+                          _numaStatsCallback);
+        }
 
         /// saves word vectors to file with _modelFile name
         bool save(const std::string &_modelFile) const noexcept override;
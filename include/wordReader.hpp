@@ -9,13 +9,93 @@
 #ifndef WORD2VEC_WORDREADER_H
 #define WORD2VEC_WORDREADER_H
 
+#include <cstdint>
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <stdexcept>
+#include <vector>
 
 #include "mapper.hpp"
 
 namespace w2v {
+    /// half-open range [from, to) of a mapped data
+    struct range_t final {
+        off_t from; ///< first position of the range
+        off_t to; ///< position next to the last one of the range
+    };
+
+    /**
+     * @brief Delimiter chars scanner
+     *
+     * Word delimiter and end of sentence char sets are compiled into a 256-entry char class table. The same set of
+     * word delimiters is also compiled into two nibble bitmaps, so the end of a word is searched 16 or 32 chars at a
+     * time with SSSE3/AVX2 byte shuffles. The best implementation is selected once at runtime by CPUID.
+    */
+    class delimiterScanner_t final {
+    public:
+        /// char class
+        enum charClass_t: uint8_t {
+            WORD_CHAR = 0, ///< word char
+            WORD_DELIMITER = 1, ///< word delimiter
+            END_OF_SENTENCE = 2 ///< word delimiter and end of sentence
+        };
+
+        /// delimiter chars search implementation, see find()
+        using findImpl_t = const char *(*)(const delimiterScanner_t &_scanner, const char *_from, const char *_to);
+
+    private:
+        friend struct delimiterScannerImpl_t;
+
+        uint8_t m_classes[256]; // char classes
+        uint8_t m_lowBitmap[16]; // word delimiters with high nibble 0..7, bit per high nibble, indexed by low nibble
+        uint8_t m_highBitmap[16]; // word delimiters with high nibble 8..15, bit per high nibble, indexed by low nibble
+
+    public:
+        /**
+         * Constructs a scanner
+         * @param _wordDelimiterChars word delimiter chars
+         * @param _endOfSentenceChars end of sentence chars, only chars which are word delimiters too are used
+        */
+        delimiterScanner_t(const std::string &_wordDelimiterChars, const std::string &_endOfSentenceChars) noexcept:
+                m_classes(), m_lowBitmap(), m_highBitmap() {
+            for (auto ch:_wordDelimiterChars) {
+                auto c = static_cast<uint8_t>(ch);
+                m_classes[c] = WORD_DELIMITER;
+                if (c < 0x80U) {
+                    m_lowBitmap[c & 0x0fU] |= static_cast<uint8_t>(1U << (c >> 4U));
+                } else {
+                    m_highBitmap[c & 0x0fU] |= static_cast<uint8_t>(1U << ((c >> 4U) - 8U));
+                }
+            }
+            for (auto ch:_endOfSentenceChars) {
+                auto c = static_cast<uint8_t>(ch);
+                if (m_classes[c] != WORD_CHAR) {
+                    m_classes[c] = END_OF_SENTENCE;
+                }
+            }
+        }
+
+        /// @returns class of the _ch char
+        inline charClass_t charClass(char _ch) const noexcept {
+            return static_cast<charClass_t>(m_classes[static_cast<uint8_t>(_ch)]);
+        }
+
+        /**
+         * Searches for the first delimiter char
+         * @param _from start of the search range
+         * @param _to end of the search range (excluded)
+         * @returns pointer to the first delimiter char or _to if there is no delimiters in the range
+        */
+        const char *find(const char *_from, const char *_to) const noexcept;
+
+        /**
+         * Lists all search implementations the CPU can run, so they can be verified against each other
+         * @returns implementations from the generic one to the one used by find()
+        */
+        static std::vector<findImpl_t> implementations();
+    };
+
     /**
      * @brief Text parser (word by word)
      *
@@ -26,14 +106,11 @@ namespace w2v {
     class wordReader_t final {
     private:
         const dataMapper_t &m_mapper; // reference to mapper_t derived class object
-        std::string m_wordDelimiterChars;
-        std::string m_endOfSentenceChars;
+        const delimiterScanner_t m_scanner; // delimiter chars scanner
         const uint16_t m_maxWordLen; // max word length
         off_t m_offset; // current offset
         const off_t m_startFrom; // start from position
         const off_t m_stopAt; // stop at position
-        std::string m_word; // current word buffer
-        std::size_t m_wordPos = 0; // position in the current word buffer
         bool m_prvEOS = false; // is the previous char a sentence delimiter char?
 
     public:
@@ -41,7 +118,7 @@ namespace w2v {
          * Constructs a wordReader of a memory mapped file (_mapper object)
          * @param _mapper mapper_t derived class object that provides read access to a mapped memory
          * @param _offset start parsing from this offset position
-         * @param _stopAt stop parsing at this position
+         * @param _stopAt stop parsing at this position, 0 - parse to the end of the data
          * @param _maxWordLen max length of a parsing word
          * @throws std::range_error In case of _offset or/and _stopAt are out of bounds
         */
@@ -50,11 +127,9 @@ namespace w2v {
                      std::string _endOfSentenceChars,
                      off_t _offset = 0, off_t _stopAt = 0, uint16_t _maxWordLen = 100):
                 m_mapper(_mapper),
-                m_wordDelimiterChars(std::move(_wordDelimiterChars)),
-                m_endOfSentenceChars(std::move(_endOfSentenceChars)),
+                m_scanner(_wordDelimiterChars, _endOfSentenceChars),
                 m_maxWordLen(_maxWordLen), m_offset(_offset),
-                m_startFrom(m_offset), m_stopAt((_stopAt == 0)?_mapper.size() - 1:_stopAt),
-                m_word(m_maxWordLen, 0) {
+                m_startFrom(m_offset), m_stopAt((_stopAt == 0)?_mapper.size() - 1:_stopAt) {
 
             if (m_stopAt >= m_mapper.size()) {
                 throw std::range_error("wordReader: bounds are out of the file size");
@@ -64,6 +139,30 @@ namespace w2v {
             }
         }
 
+        /**
+         * Constructs a wordReader of a part of a memory mapped file (_mapper object)
+         * @param _mapper mapper_t derived class object that provides read access to a mapped memory
+         * @param _range parsing range, its end is always an explicit position, even if the range is the first char
+         * @param _maxWordLen max length of a parsing word
+         * @throws std::range_error In case of _range is empty or out of bounds
+        */
+        wordReader_t(const dataMapper_t &_mapper,
+                     std::string _wordDelimiterChars,
+                     std::string _endOfSentenceChars,
+                     const range_t &_range, uint16_t _maxWordLen = 100):
+                m_mapper(_mapper),
+                m_scanner(_wordDelimiterChars, _endOfSentenceChars),
+                m_maxWordLen(_maxWordLen), m_offset(_range.from),
+                m_startFrom(m_offset), m_stopAt(_range.to - 1) {
+
+            if (_range.to > m_mapper.size()) {
+                throw std::range_error("wordReader: bounds are out of the file size");
+            }
+            if ((m_offset < 0) || (m_offset > m_stopAt)) {
+                throw std::range_error("wordReader: offset is out of the bounds");
+            }
+        }
+
         // copying prohibited
         wordReader_t(const wordReader_t &) = delete;
         void operator=(const wordReader_t &) = delete;
@@ -74,58 +173,68 @@ namespace w2v {
         /// Resets parser state, start parsing from the begining
         inline void reset() noexcept {
             m_offset = m_startFrom;
-            m_wordPos = 0;
             m_prvEOS = false;
         }
 
         /**
-         * Reads next word
-         * @param[out] _word  string where the next parsed word to be stored. Empty string means end of sentence.
+         * Reads next word without copying
+         * @param[out] _word pointer to the next parsed word in the mapped memory, valid while the mapper exists
+         * @param[out] _length length of the word, longer words are truncated to the max word length. Zero length
+         * means end of sentence.
          * @returns true if word is succesfuly parsed, false in case of EOF or end of parsing block reached (_stopAt).
         */
-        inline bool nextWord(std::string &_word) noexcept {
+        inline bool nextWord(const char *&_word, std::size_t &_length) noexcept {
+            const char *data = m_mapper.data();
             while (m_offset <= m_stopAt) {
-                char ch = m_mapper.data()[m_offset++];
-                if (m_wordDelimiterChars.find(ch) != std::string::npos) { // is it a word/sentence delimiter?
-                    if (m_endOfSentenceChars.find(ch) != std::string::npos) { // is it the end of sentence (EOS)?
-                        if (m_wordPos > 0) { // is here any buffered word? if yes - return this word and move back
-                            m_offset--;
-                            m_prvEOS = false;
-                            break;
-                        } else {
-                            if (!m_prvEOS) { // Do not return repeated EOS, return only the first occurrence.
-                                _word.clear();
-                                m_prvEOS = true;
-                                return true;
-                            } else {
-                                continue; // skip this EOS
-                            }
+                auto charClass = m_scanner.charClass(data[m_offset]);
+                if (charClass == delimiterScanner_t::WORD_CHAR) { // the whole word is found at once
+                    const char *from = data + m_offset;
+                    const char *to = m_scanner.find(from, data + m_stopAt + 1);
+                    m_offset += to - from;
+                    _word = from;
+                    _length = std::min(static_cast<std::size_t>(to - from),
+                                       static_cast<std::size_t>(m_maxWordLen)); // check bounds
+                    if (m_offset <= m_stopAt) {
+                        // skip the word delimiter, but do not skip the end of sentence
+                        if (m_scanner.charClass(data[m_offset]) != delimiterScanner_t::END_OF_SENTENCE) {
+                            m_offset++;
                         }
-                    }
-                    if (m_wordPos > 0) { // it is a word delimiter, is here any buffered word?
                         m_prvEOS = false;
-                        break;
-                    } else {
-                        continue; // skip repeated word delimiters
                     }
+                    return true;
                 }
-                if (m_wordPos < m_maxWordLen) { // check bounds
-                    m_word[m_wordPos++] = ch; // it's next char of buffered word
-                }
-            }
-            if (m_wordPos > 0) { // return buffered word
-                try {
-                    _word.resize(m_wordPos);
-                    std::copy(m_word.data(), m_word.data() + m_wordPos, &_word[0]);
-                } catch (...) { // bad_alloc
-                    return false;
+                m_offset++;
+                // is it the end of sentence (EOS)? Do not return repeated EOS, return only the first occurrence.
+                if ((charClass == delimiterScanner_t::END_OF_SENTENCE) && !m_prvEOS) {
+                    _word = data + m_offset - 1;
+                    _length = 0;
+                    m_prvEOS = true;
+                    return true;
                 }
-                m_wordPos = 0;
-                return true;
+                // skip repeated word delimiters and EOS
             }
 
             return false; // eof or end of the requested block
         }
+
+        /**
+         * Reads next word
+         * @param[out] _word  string where the next parsed word to be stored. Empty string means end of sentence.
+         * @returns true if word is succesfuly parsed, false in case of EOF or end of parsing block reached (_stopAt).
+        */
+        inline bool nextWord(std::string &_word) noexcept {
+            const char *word = nullptr;
+            std::size_t length = 0;
+            if (!nextWord(word, length)) {
+                return false; // eof or end of the requested block
+            }
+            try {
+                _word.assign(word, length);
+            } catch (...) { // bad_alloc
+                return false;
+            }
+            return true;
+        }
     };
 }
 
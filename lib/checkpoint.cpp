@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief checkpoint structure - training state saved periodically to resume an interrupted training
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "checkpoint.hpp"
+
+namespace w2v {
+    static const char checkpointMagic[8] = {'W', '2', 'V', 'C', 'H', 'K', 'P', 'T'};
+    static const uint32_t checkpointVersion = 1;
+
+    namespace {
+        /// sequential writer of checkpoint values
+        class writer_t final {
+        private:
+            std::ofstream &m_output;
+
+        public:
+            explicit writer_t(std::ofstream &_output): m_output(_output) {}
+
+            void bytes(const void *_data, std::size_t _size) {
+                m_output.write(static_cast<const char *>(_data), static_cast<std::streamsize>(_size));
+            }
+            void value(uint64_t _value) {bytes(&_value, sizeof(_value));}
+            void value(float _value) {bytes(&_value, sizeof(_value));}
+            void value(const std::string &_value) {
+                value(static_cast<uint64_t>(_value.size()));
+                bytes(_value.data(), _value.size());
+            }
+            void value(const std::vector<uint8_t> &_value) {
+                value(static_cast<uint64_t>(_value.size()));
+                bytes(_value.data(), _value.size());
+            }
+        };
+
+        /// sequential reader of checkpoint values, sizes are checked against the rest of the file
+        class reader_t final {
+        private:
+            std::ifstream &m_input;
+            const std::string &m_fileName;
+            uint64_t m_left;
+
+        public:
+            reader_t(std::ifstream &_input, const std::string &_fileName, uint64_t _size):
+                    m_input(_input), m_fileName(_fileName), m_left(_size) {}
+
+            [[noreturn]] void wrongFormat() const {
+                throw std::runtime_error(std::string("checkpoint: ") + m_fileName + " - wrong file format");
+            }
+
+            void bytes(void *_data, uint64_t _size) {
+                if (_size > m_left) {
+                    wrongFormat();
+                }
+                m_input.read(static_cast<char *>(_data), static_cast<std::streamsize>(_size));
+                if (!m_input) {
+                    wrongFormat();
+                }
+                m_left -= _size;
+            }
+            uint64_t u64() {
+                uint64_t ret = 0;
+                bytes(&ret, sizeof(ret));
+                return ret;
+            }
+            float f32() {
+                float ret = 0.0f;
+                bytes(&ret, sizeof(ret));
+                return ret;
+            }
+            std::string string() {
+                auto size = u64();
+                if (size > m_left) {
+                    wrongFormat();
+                }
+                std::string ret(size, '\0');
+                bytes(&ret[0], size);
+                return ret;
+            }
+            void vector(std::vector<uint8_t> &_output) {
+                auto size = u64();
+                if (size > m_left) {
+                    wrongFormat();
+                }
+                _output.resize(size);
+                bytes(_output.data(), size);
+            }
+            uint64_t left() const noexcept {return m_left;}
+        };
+    }
+
+    void checkpoint_t::save(const std::string &_fileName, const trainSettings_t &_trainSettings) const {
+        // a temporary file is renamed when it is complete, so an incomplete checkpoint file is never resumed
+        auto tmpName = _fileName + ".tmp";
+        std::ofstream output(tmpName, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            throw std::runtime_error(std::string("checkpoint: ") + tmpName + " - " + std::strerror(errno));
+        }
+
+        writer_t writer(output);
+        writer.bytes(checkpointMagic, sizeof(checkpointMagic));
+        writer.value(static_cast<uint64_t>(checkpointVersion));
+
+        // model parameters
+        writer.value(static_cast<uint64_t>(_trainSettings.minWordFreq));
+        writer.value(static_cast<uint64_t>(_trainSettings.maxDistinctWords));
+        writer.value(static_cast<uint64_t>(_trainSettings.size));
+        writer.value(static_cast<uint64_t>(_trainSettings.window));
+        writer.value(static_cast<uint64_t>(_trainSettings.expTableSize));
+        writer.value(static_cast<uint64_t>(_trainSettings.expValueMax));
+        writer.value(_trainSettings.sample);
+        writer.value(static_cast<uint64_t>(_trainSettings.withHS));
+        writer.value(static_cast<uint64_t>(_trainSettings.negative));
+        writer.value(static_cast<uint64_t>(_trainSettings.iterations));
+        writer.value(_trainSettings.alpha);
+        writer.value(static_cast<uint64_t>(_trainSettings.withSG));
+        writer.value(static_cast<uint64_t>(_trainSettings.withBatchedSG));
+        writer.value(static_cast<uint64_t>(_trainSettings.precision));
+        writer.value(_trainSettings.corpusCacheFile);
+        writer.value(_trainSettings.wordDelimiterChars);
+        writer.value(_trainSettings.endOfSentenceChars);
+
+        // training state
+        writer.value(seed);
+        writer.value(trainDataSize);
+        writer.value(trainDataFiles);
+        writer.value(chunks);
+        writer.value(position);
+        writer.value(processedWords);
+        writer.value(trainWords);
+        writer.value(totalWords);
+        writer.value(prunedWords);
+        writer.value(static_cast<uint64_t>(words.size()));
+        for (auto const &i:words) {
+            writer.value(i.first);
+            writer.value(static_cast<uint64_t>(i.second));
+        }
+        writer.value(trainMatrix);
+        writer.value(bpWeights);
+
+        output.close();
+        if (!output) {
+            std::remove(tmpName.c_str());
+            throw std::runtime_error(std::string("checkpoint: ") + tmpName + " - write failed");
+        }
+        if (std::rename(tmpName.c_str(), _fileName.c_str()) != 0) {
+            throw std::runtime_error(std::string("checkpoint: ") + _fileName + " - " + std::strerror(errno));
+        }
+    }
+
+    void checkpoint_t::load(const std::string &_fileName, trainSettings_t &_trainSettings) {
+        std::ifstream input(_fileName, std::ios::binary | std::ios::ate);
+        if (!input) {
+            throw std::runtime_error(std::string("checkpoint: ") + _fileName + " - " + std::strerror(errno));
+        }
+        auto fileSize = static_cast<uint64_t>(input.tellg());
+        input.seekg(0);
+
+        reader_t reader(input, _fileName, fileSize);
+        char magic[sizeof(checkpointMagic)] = {};
+        reader.bytes(magic, sizeof(magic));
+        if ((std::memcmp(magic, checkpointMagic, sizeof(checkpointMagic)) != 0)
+            || (reader.u64() != checkpointVersion)) {
+            reader.wrongFormat();
+        }
+
+        trainSettings_t settings = _trainSettings;
+        settings.minWordFreq = static_cast<uint16_t>(reader.u64());
+        settings.maxDistinctWords = static_cast<std::size_t>(reader.u64());
+        settings.size = static_cast<uint16_t>(reader.u64());
+        settings.window = static_cast<uint8_t>(reader.u64());
+        settings.expTableSize = static_cast<uint16_t>(reader.u64());
+        settings.expValueMax = static_cast<uint8_t>(reader.u64());
+        settings.sample = reader.f32();
+        settings.withHS = reader.u64() != 0;
+        settings.negative = static_cast<uint8_t>(reader.u64());
+        settings.iterations = static_cast<uint8_t>(reader.u64());
+        settings.alpha = reader.f32();
+        settings.withSG = reader.u64() != 0;
+        settings.withBatchedSG = reader.u64() != 0;
+        auto precision = reader.u64();
+        if (precision > static_cast<uint64_t>(matrixPrecision_t::FP16)) {
+            reader.wrongFormat();
+        }
+        settings.precision = static_cast<matrixPrecision_t>(precision);
+        settings.corpusCacheFile = reader.string();
+        settings.wordDelimiterChars = reader.string();
+        settings.endOfSentenceChars = reader.string();
+
+        seed = reader.u64();
+        trainDataSize = reader.u64();
+        trainDataFiles = reader.u64();
+        chunks = reader.u64();
+        position = reader.u64();
+        processedWords = reader.u64();
+        trainWords = reader.u64();
+        totalWords = reader.u64();
+        prunedWords = reader.u64();
+        auto wordsNumber = reader.u64();
+        // each word takes at least its length and frequency
+        if (wordsNumber > reader.left() / (sizeof(uint64_t) * 2)) {
+            reader.wrongFormat();
+        }
+        words.clear();
+        words.reserve(static_cast<std::size_t>(wordsNumber));
+        for (uint64_t i = 0; i < wordsNumber; ++i) {
+            auto word = reader.string();
+            auto frequency = static_cast<std::size_t>(reader.u64());
+            words.emplace_back(std::move(word), frequency);
+        }
+        reader.vector(trainMatrix);
+        reader.vector(bpWeights);
+
+        const std::size_t elementSize = (settings.precision == matrixPrecision_t::FP32) ? sizeof(float)
+                                                                                        : sizeof(uint16_t);
+        const std::size_t matrixBytes = words.size() * settings.size * elementSize;
+        if ((reader.left() != 0) || (chunks == 0) || (position > chunks * settings.iterations)
+            || (trainMatrix.size() != matrixBytes) || (bpWeights.size() != matrixBytes)) {
+            reader.wrongFormat();
+        }
+
+        _trainSettings = settings;
+    }
+}
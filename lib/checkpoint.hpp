@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief checkpoint structure - training state saved periodically to resume an interrupted training
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_CHECKPOINT_H
+#define WORD2VEC_CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "word2vec.hpp"
+
+namespace w2v {
+    /**
+     * @brief checkpoint structure - training state saved periodically to resume an interrupted training
+     *
+     * A checkpoint holds everything the training depends on: model parameters of the train settings, the random
+     * generators seed, the vocabulary with word frequencies, the position in the sequence of train data chunks
+     * (see trainChunks_t), processed words number and both training matrices in their storage format.
+     * Runtime parameters (threads, CPU affinity, memory placement, thread private rows, prefetching and checkpoints
+     * themselves) are not saved, they are taken from the settings of the resumed training.
+     * A checkpoint file is written to a temporary file which is renamed then, so the previous checkpoint file is
+     * valid until the next one is complete. The final training state is saved the same way, a trained model is
+     * updated with new train data from it (see w2vModel_t::update()).
+    */
+    struct checkpoint_t final {
+        uint64_t seed = 0; ///< random generators seed of the training
+        uint64_t trainDataSize = 0; ///< train data size, a checkpoint is resumed with the same train data
+        uint64_t trainDataFiles = 1; ///< train data files number
+        uint64_t chunks = 0; ///< train data chunks number of one iteration
+        uint64_t position = 0; ///< sequence number of the first chunk trained after resume
+        uint64_t processedWords = 0; ///< words processed by all train threads
+        uint64_t trainWords = 0; ///< vocabulary train words
+        uint64_t totalWords = 0; ///< vocabulary total words
+        uint64_t prunedWords = 0; ///< vocabulary pruned words
+        std::vector<std::pair<std::string, std::size_t>> words; ///< vocabulary words in index order, frequencies
+        std::vector<uint8_t> trainMatrix; ///< packed rows of the input matrix in the storage format
+        std::vector<uint8_t> bpWeights; ///< packed rows of the back propagation weights in the storage format
+
+        /**
+         * Saves the checkpoint
+         * @param _fileName checkpoint file name
+         * @param _trainSettings settings of the training, model parameters are saved
+         * @throws std::runtime_error In case of failed file operations
+        */
+        void save(const std::string &_fileName, const trainSettings_t &_trainSettings) const;
+
+        /**
+         * Loads a checkpoint
+         * @param _fileName checkpoint file name
+         * @param[in,out] _trainSettings model parameters are replaced by the saved ones, runtime parameters are kept
+         * @throws std::runtime_error In case of failed file operations or wrong file format
+        */
+        void load(const std::string &_fileName, trainSettings_t &_trainSettings);
+    };
+}
+
+#endif // WORD2VEC_CHECKPOINT_H
@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @brief corpus class - train data of many text files, directories and the standard input
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "corpus.hpp"
+
+namespace w2v {
+    corpus_t::corpus_t(const std::vector<std::string> &_sources):
+            m_files(), m_names(), m_offsets(1, 0), m_compressed(), m_compressedNames() {
+        bool stdinRead = false;
+        for (auto const &i:_sources) {
+            if (i == "-") {
+                if (stdinRead) {
+                    throw std::runtime_error("corpus: the standard input can be read only once");
+                }
+                stdinRead = true;
+                add("stdin", std::unique_ptr<mapper_t>(new streamMapper_t(STDIN_FILENO, "stdin", maxStdinSize)));
+                continue;
+            }
+
+            struct stat fst{};
+            if (stat(i.c_str(), &fst) < 0) {
+                throw std::runtime_error(std::string("corpus: ") + i + " - " + std::strerror(errno));
+            }
+            if (S_ISDIR(fst.st_mode)) {
+                addDirectory(i);
+            } else {
+                add(i, std::unique_ptr<mapper_t>(new fileMapper_t(i)));
+            }
+        }
+
+        if (m_files.empty() && m_compressed.empty()) {
+            throw std::runtime_error("corpus: no train data");
+        }
+    }
+
+    void corpus_t::add(const std::string &_name, std::unique_ptr<mapper_t> &&_file) {
+        const auto size = static_cast<std::size_t>(_file->size());
+        if ((size >= 2) && (static_cast<uint8_t>(_file->data()[0]) == 0x1fU)
+            && (static_cast<uint8_t>(_file->data()[1]) == 0x8bU)) {
+            m_compressedSize += size;
+            m_compressedNames.push_back(_name);
+            m_compressed.push_back(std::move(_file));
+            return;
+        }
+
+        m_offsets.push_back(m_offsets.back() + size);
+        m_names.push_back(_name);
+        m_files.push_back(std::move(_file));
+    }
+
+    void corpus_t::addDirectory(const std::string &_path) {
+        DIR *dir = opendir(_path.c_str());
+        if (dir == nullptr) {
+            throw std::runtime_error(std::string("corpus: ") + _path + " - " + std::strerror(errno));
+        }
+        std::vector<std::string> entries;
+        for (auto entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                entries.emplace_back(_path + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+
+        // the order of files does not depend on the file system, so chunks of a resumed training are the same
+        std::sort(entries.begin(), entries.end());
+        for (auto const &i:entries) {
+            struct stat fst{};
+            if (stat(i.c_str(), &fst) < 0) {
+                throw std::runtime_error(std::string("corpus: ") + i + " - " + std::strerror(errno));
+            }
+            if (S_ISDIR(fst.st_mode)) {
+                addDirectory(i);
+            } else if (S_ISREG(fst.st_mode) && (fst.st_size > 0)) {
+                add(i, std::unique_ptr<mapper_t>(new fileMapper_t(i)));
+            }
+        }
+    }
+}
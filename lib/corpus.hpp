@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @brief corpus class - train data of many text files, directories and the standard input
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_CORPUS_H
+#define WORD2VEC_CORPUS_H
+
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapper.hpp"
+
+namespace w2v {
+    /**
+     * @brief corpus class - train data of many text files, directories and the standard input
+     *
+     * Train data sources are files, directories and "-" for the standard input. Files of a directory are taken
+     * recursively in the order of their paths, hidden and empty files are skipped. Files are mapped into memory, the
+     * standard input is read into memory once, so it may be a pipe, its size is limited by maxStdinSize. Files follow each other in one offset space in
+     * the order of sources, the end of a file is the end of a sentence and no word spans two files. Train data is
+     * divided into chunks by files and byte ranges of files (see trainChunks_t), so vocabulary building and training
+     * threads work on a sharded corpus without concatenating it.
+     * Files starting with the gzip magic bytes are kept apart as compressed files, they are not a part of the offset
+     * space and they are decoded by gzipReader_t.
+    */
+    class corpus_t final {
+    public:
+        /// max size of the standard input, it is held in memory as a whole
+        static const uint64_t maxStdinSize = 4ULL * 1024 * 1024 * 1024;
+
+    private:
+        std::vector<std::unique_ptr<mapper_t>> m_files; // mapped files
+        std::vector<std::string> m_names; // file names
+        std::vector<std::size_t> m_offsets; // i-th file starts at m_offsets[i], the last value is the corpus size
+        std::vector<std::unique_ptr<mapper_t>> m_compressed; // mapped gzip compressed files
+        std::vector<std::string> m_compressedNames; // compressed file names
+        std::size_t m_compressedSize = 0; // size of all compressed files
+
+        void add(const std::string &_name, std::unique_ptr<mapper_t> &&_file);
+        void addDirectory(const std::string &_path);
+
+    public:
+        /**
+         * Maps train data sources
+         * @param _sources file names, directory names or "-" for the standard input
+         * @throws std::runtime_error In case of failed file operations or if there is no train data
+        */
+        explicit corpus_t(const std::vector<std::string> &_sources);
+
+        // copying prohibited
+        corpus_t(const corpus_t &) = delete;
+        void operator=(const corpus_t &) = delete;
+
+        /// @returns train data size of all text files
+        inline std::size_t size() const noexcept {return m_offsets.back();}
+        /// @returns text files number
+        inline std::size_t files() const noexcept {return m_files.size();}
+        /// @returns _index-th file
+        inline const mapper_t &file(std::size_t _index) const noexcept {return *m_files[_index];}
+        /// @returns name of the _index-th file
+        inline const std::string &name(std::size_t _index) const noexcept {return m_names[_index];}
+        /// @returns offset of the _index-th file start in the corpus
+        inline std::size_t offset(std::size_t _index) const noexcept {return m_offsets[_index];}
+
+        /// @returns compressed files number
+        inline std::size_t compressedFiles() const noexcept {return m_compressed.size();}
+        /// @returns _index-th compressed file
+        inline const mapper_t &compressedFile(std::size_t _index) const noexcept {return *m_compressed[_index];}
+        /// @returns name of the _index-th compressed file
+        inline const std::string &compressedName(std::size_t _index) const noexcept {
+            return m_compressedNames[_index];
+        }
+        /// @returns size of all compressed files
+        inline std::size_t compressedSize() const noexcept {return m_compressedSize;}
+
+        /// @returns index of the file containing the corpus offset _offset
+        inline std::size_t fileAt(std::size_t _offset) const noexcept {
+            return static_cast<std::size_t>(std::upper_bound(m_offsets.begin(), m_offsets.end(), _offset)
+                                            - m_offsets.begin()) - 1;
+        }
+    };
+}
+
+#endif // WORD2VEC_CORPUS_H
@@ -0,0 +1,266 @@
+/**
+ * @file
+ * @brief corpusCache class - pre-tokenized binary stream of a train corpus
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <exception>
+#include <vector>
+
+#include "corpusCache.hpp"
+#include "wordReader.hpp"
+#include "trainChunks.hpp"
+#include "gzipReader.hpp"
+
+namespace w2v {
+    static const char cacheMagic[8] = {'W', '2', 'V', 'C', 'A', 'C', 'H', 'E'};
+    static const uint32_t cacheVersion = 1;
+
+    corpusCache_t::corpusCache_t(const std::string &_fileName,
+                                 const corpus_t &_corpus,
+                                 const vocabulary_t &_vocabulary,
+                                 const trainSettings_t &_trainSettings): m_mapper() {
+        auto cacheHash = hash(_corpus, _vocabulary, _trainSettings);
+        m_reused = map(_fileName, cacheHash);
+        if (!m_reused) {
+            build(_fileName, cacheHash, _corpus, _vocabulary, _trainSettings);
+            if (!map(_fileName, cacheHash)) {
+                throw std::runtime_error(std::string("corpusCache: ") + _fileName + " - wrong file format");
+            }
+        }
+    }
+
+    corpusCache_t::corpusCache_t(const corpus_t &_corpus,
+                                 const vocabulary_t &_vocabulary,
+                                 const trainSettings_t &_trainSettings): m_mapper() {
+        const char *tmpDir = std::getenv("TMPDIR");
+        std::string fileName = std::string(((tmpDir != nullptr) && (*tmpDir != 0)) ? tmpDir : "/tmp")
+                               + "/w2v_cache_XXXXXX";
+        auto fd = mkstemp(&fileName[0]);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("corpusCache: ") + fileName + " - " + std::strerror(errno));
+        }
+        close(fd);
+
+        auto cacheHash = hash(_corpus, _vocabulary, _trainSettings);
+        try {
+            build(fileName, cacheHash, _corpus, _vocabulary, _trainSettings);
+            if (!map(fileName, cacheHash)) {
+                throw std::runtime_error(std::string("corpusCache: ") + fileName + " - wrong file format");
+            }
+        } catch (...) {
+            std::remove(fileName.c_str());
+            throw;
+        }
+        // the mapping outlives the file name
+        std::remove(fileName.c_str());
+    }
+
+    uint64_t corpusCache_t::hash(const corpus_t &_corpus,
+                                 const vocabulary_t &_vocabulary,
+                                 const trainSettings_t &_trainSettings) noexcept {
+        // FNV-1a
+        uint64_t ret = 0xcbf29ce484222325ULL;
+        auto update = [&ret](const void *_data, std::size_t _size) {
+            auto data = static_cast<const uint8_t *>(_data);
+            for (std::size_t i = 0; i < _size; ++i) {
+                ret = (ret ^ data[i]) * 0x100000001b3ULL;
+            }
+        };
+
+        uint64_t value = _corpus.files();
+        update(&value, sizeof(value));
+        for (std::size_t i = 0; i < _corpus.files(); ++i) {
+            value = static_cast<uint64_t>(_corpus.file(i).size());
+            update(&value, sizeof(value));
+        }
+        value = _corpus.compressedFiles();
+        update(&value, sizeof(value));
+        for (std::size_t i = 0; i < _corpus.compressedFiles(); ++i) {
+            value = static_cast<uint64_t>(_corpus.compressedFile(i).size());
+            update(&value, sizeof(value));
+        }
+        update(_trainSettings.wordDelimiterChars.data(), _trainSettings.wordDelimiterChars.size() + 1);
+        update(_trainSettings.endOfSentenceChars.data(), _trainSettings.endOfSentenceChars.size() + 1);
+        // words in index order with their frequencies
+        std::vector<std::string> words;
+        _vocabulary.words(words);
+        for (auto const &i:words) {
+            update(i.c_str(), i.size() + 1);
+            value = _vocabulary.data(i)->frequency;
+            update(&value, sizeof(value));
+        }
+
+        return ret;
+    }
+
+    void corpusCache_t::build(const std::string &_fileName,
+                              uint64_t _hash,
+                              const corpus_t &_corpus,
+                              const vocabulary_t &_vocabulary,
+                              const trainSettings_t &_trainSettings) {
+        // each thread encodes its range of the corpus chunks to a separate file, parts are concatenated then
+        const std::size_t parts = (_trainSettings.threads > 0) ? _trainSettings.threads : 1;
+        const delimiterScanner_t scanner(_trainSettings.wordDelimiterChars, _trainSettings.endOfSentenceChars);
+        const trainChunks_t chunks(_corpus, scanner, parts, 1);
+        // compressed files are decoded by dedicated threads, decoded blocks are encoded by the part threads
+        std::unique_ptr<gzipReader_t> gzipReader;
+        if (_corpus.compressedFiles() > 0) {
+            gzipReader.reset(new gzipReader_t(_corpus, scanner, _trainSettings.decompressionThreads, parts, parts * 2));
+        }
+        std::vector<std::string> partNames(parts);
+        std::vector<std::size_t> partSizes(parts, 0);
+        std::vector<std::exception_ptr> partErrors(parts);
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < parts; ++p) {
+            partNames[p] = _fileName + ".part" + std::to_string(p);
+            threads.emplace_back([&, p]() {
+                try {
+                    std::ofstream output(partNames[p], std::ios::binary | std::ios::trunc);
+                    if (!output) {
+                        throw std::runtime_error(std::string("corpusCache: ") + partNames[p] + " - "
+                                                 + std::strerror(errno));
+                    }
+                    std::vector<uint8_t> buffer;
+                    buffer.reserve(1024 * 1024 + 16);
+                    auto flush = [&]() {
+                        output.write(reinterpret_cast<const char *>(buffer.data()),
+                                     static_cast<std::streamsize>(buffer.size()));
+                        partSizes[p] += buffer.size();
+                        buffer.clear();
+                    };
+
+                    auto encode = [&](wordReader_t<mapper_t> &_wordReader) {
+                        bool sentence = false;
+                        const char *word = nullptr;
+                        std::size_t length = 0;
+                        while (_wordReader.nextWord(word, length)) {
+                            if (length == 0) {
+                                if (sentence) {
+                                    buffer.push_back(0);
+                                    sentence = false;
+                                }
+                            } else {
+                                auto wordData = _vocabulary.data(word, length);
+                                if (wordData == nullptr) {
+                                    continue;
+                                }
+                                put(static_cast<uint32_t>(wordData->index + 1), buffer);
+                                sentence = true;
+                            }
+                            if (buffer.size() >= 1024 * 1024) {
+                                flush();
+                            }
+                        }
+                        if (sentence) {
+                            buffer.push_back(0);
+                        }
+                    };
+
+                    // the end of a chunk is the end of a sentence, train threads stop there as well
+                    for (auto c = chunks.size() * p / parts; c < chunks.size() * (p + 1) / parts; ++c) {
+                        const auto file = _corpus.fileAt(chunks.bound(c));
+                        const auto offset = _corpus.offset(file);
+                        wordReader_t<mapper_t> wordReader(_corpus.file(file),
+                                                          _trainSettings.wordDelimiterChars,
+                                                          _trainSettings.endOfSentenceChars,
+                                                          range_t{static_cast<off_t>(chunks.bound(c) - offset),
+                                                                  static_cast<off_t>(chunks.bound(c + 1) - offset)});
+                        encode(wordReader);
+                    }
+                    // the end of a decoded block is the end of a sentence as well, blocks are dealt to parts in the
+                    // text order, so the cache is the same every time it is built
+                    std::string block;
+                    while (gzipReader && gzipReader->next(p, block)) {
+                        stringMapper_t mapper(block);
+                        wordReader_t<mapper_t> wordReader(mapper, _trainSettings.wordDelimiterChars,
+                                                          _trainSettings.endOfSentenceChars);
+                        encode(wordReader);
+                    }
+                    flush();
+                    output.close();
+                    if (!output) {
+                        throw std::runtime_error(std::string("corpusCache: ") + partNames[p] + " - write failed");
+                    }
+                } catch (...) {
+                    partErrors[p] = std::current_exception();
+                    // the blocks of this part are never taken, the other parts must not wait for them
+                    if (gzipReader) {
+                        gzipReader->stop();
+                    }
+                }
+            });
+        }
+        for (auto &i:threads) {
+            i.join();
+        }
+        for (auto const &i:partErrors) {
+            if (i) {
+                for (auto const &j:partNames) {
+                    std::remove(j.c_str());
+                }
+                std::rethrow_exception(i);
+            }
+        }
+
+        // concatenate parts to a temporary file and rename it, so an incomplete cache file is never used
+        header_t header{};
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.version = cacheVersion;
+        header.hash = _hash;
+        for (auto i:partSizes) {
+            header.size += i;
+        }
+        auto tmpName = _fileName + ".tmp";
+        {
+            fileMapper_t output(tmpName, true, static_cast<off_t>(sizeof(header) + header.size));
+            std::memcpy(output.data(), &header, sizeof(header));
+            std::size_t offset = sizeof(header);
+            for (std::size_t p = 0; p < parts; ++p) {
+                if (partSizes[p] > 0) {
+                    fileMapper_t input(partNames[p]);
+                    std::memcpy(output.data() + offset, input.data(), partSizes[p]);
+                    offset += partSizes[p];
+                }
+                std::remove(partNames[p].c_str());
+            }
+        }
+        if (std::rename(tmpName.c_str(), _fileName.c_str()) != 0) {
+            throw std::runtime_error(std::string("corpusCache: ") + _fileName + " - " + std::strerror(errno));
+        }
+    }
+
+    bool corpusCache_t::map(const std::string &_fileName, uint64_t _hash) {
+        struct stat fst{};
+        if ((stat(_fileName.c_str(), &fst) < 0) || (static_cast<std::size_t>(fst.st_size) < sizeof(header_t))) {
+            return false;
+        }
+
+        std::unique_ptr<fileMapper_t> mapper(new fileMapper_t(_fileName));
+        header_t header{};
+        std::memcpy(&header, mapper->data(), sizeof(header));
+        if ((std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0)
+            || (header.version != cacheVersion)
+            || (header.hash != _hash)
+            || (header.size != static_cast<uint64_t>(mapper->size()) - sizeof(header))) {
+            return false;
+        }
+
+        m_mapper = std::move(mapper);
+        m_data = reinterpret_cast<const uint8_t *>(m_mapper->data()) + sizeof(header);
+        m_size = static_cast<std::size_t>(header.size);
+        return true;
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @brief corpusCache class - pre-tokenized binary stream of a train corpus
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_CORPUSCACHE_H
+#define WORD2VEC_CORPUSCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "word2vec.hpp"
+#include "mapper.hpp"
+#include "vocabulary.hpp"
+#include "corpus.hpp"
+
+namespace w2v {
+    /**
+     * @brief corpusCache class - pre-tokenized binary stream of a train corpus
+     *
+     * The train corpus is parsed once into a stream of vocabulary indexes, so the training iterations do not parse
+     * text and do not look up words in the vocabulary. Each word is stored as a LEB128 varint of (index + 1), words
+     * out of the vocabulary are dropped and the end of a non-empty sentence is stored as 0 byte. A varint never
+     * contains 0 byte, so any position of the stream can be aligned to a sentence start by searching for 0.
+     * The cache file starts with a header containing a hash of the vocabulary and parsing settings. An existing
+     * cache file is reused if the hash matches, otherwise it is rebuilt in parallel from the text corpus. Compressed
+     * files are decoded once while the cache is built, so the training iterations never decompress them again.
+    */
+    class corpusCache_t final {
+    private:
+        /// cache file header
+        struct header_t final {
+            char magic[8]; ///< file type signature
+            uint32_t version; ///< file format version
+            uint32_t reserved; ///< reserved, 0
+            uint64_t hash; ///< hash of the vocabulary and parsing settings
+            uint64_t size; ///< stream size in bytes
+        };
+
+        std::unique_ptr<fileMapper_t> m_mapper;
+        const uint8_t *m_data = nullptr;
+        std::size_t m_size = 0;
+        bool m_reused = false;
+
+    public:
+        /**
+         * Maps an existing cache file or builds it from the train corpus
+         * @param _fileName cache file name
+         * @param _corpus train corpus
+         * @param _vocabulary vocabulary built from the train corpus
+         * @param _trainSettings train settings, word delimiters and threads numbers are used
+         * @throws std::runtime_error In case of failed file operations
+        */
+        corpusCache_t(const std::string &_fileName,
+                      const corpus_t &_corpus,
+                      const vocabulary_t &_vocabulary,
+                      const trainSettings_t &_trainSettings);
+
+        /**
+         * Builds a temporary cache file from the train corpus in $TMPDIR or /tmp. The file is removed as soon as it
+         * is mapped, so it is never reused and its disk space is freed with the cache object.
+         * @param _corpus train corpus
+         * @param _vocabulary vocabulary built from the train corpus
+         * @param _trainSettings train settings, word delimiters and threads numbers are used
+         * @throws std::runtime_error In case of failed file operations
+        */
+        corpusCache_t(const corpus_t &_corpus,
+                      const vocabulary_t &_vocabulary,
+                      const trainSettings_t &_trainSettings);
+
+        // copying prohibited
+        corpusCache_t(const corpusCache_t &) = delete;
+        void operator=(const corpusCache_t &) = delete;
+
+        /// @returns pointer to the stream of word indexes
+        inline const uint8_t *data() const noexcept {return m_data;}
+        /// @returns stream size in bytes
+        inline std::size_t size() const noexcept {return m_size;}
+        /// @returns true if an existing cache file was reused
+        inline bool reused() const noexcept {return m_reused;}
+
+        /**
+         * Encodes a stream value
+         * @param _value word index + 1 or 0 for the end of sentence
+         * @param[out] _buffer buffer the encoded value is appended to
+        */
+        static inline void put(uint32_t _value, std::vector<uint8_t> &_buffer) {
+            for (; _value >= 0x80U; _value >>= 7U) {
+                _buffer.push_back(static_cast<uint8_t>(_value | 0x80U));
+            }
+            _buffer.push_back(static_cast<uint8_t>(_value));
+        }
+
+        /**
+         * Decodes the next stream value
+         * @param[in,out] _pos stream position, moved to the next value
+         * @returns word index + 1 or 0 on the end of sentence
+        */
+        static inline uint32_t next(const uint8_t *&_pos) noexcept {
+            uint32_t ret = *_pos & 0x7fU;
+            for (unsigned int shift = 7; (*_pos++ & 0x80U) != 0; shift += 7) {
+                ret |= static_cast<uint32_t>(*_pos & 0x7fU) << shift;
+            }
+            return ret;
+        }
+
+    private:
+        static uint64_t hash(const corpus_t &_corpus,
+                             const vocabulary_t &_vocabulary,
+                             const trainSettings_t &_trainSettings) noexcept;
+
+        static void build(const std::string &_fileName,
+                          uint64_t _hash,
+                          const corpus_t &_corpus,
+                          const vocabulary_t &_vocabulary,
+                          const trainSettings_t &_trainSettings);
+
+        bool map(const std::string &_fileName, uint64_t _hash);
+    };
+}
+
+#endif // WORD2VEC_CORPUSCACHE_H
@@ -8,20 +8,25 @@
 #ifndef WORD2VEC_DOWNSAMPLING_H
 #define WORD2VEC_DOWNSAMPLING_H
 
-#include <random>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "randomGenerator.hpp"
 
 namespace w2v {
     /**
      * @brief downSampling class - randomly down-sampling frequent words
      *
-     * Randomly discard a frequent word from a training sentence
+     * Randomly discard a frequent word from a training sentence. Discard probabilities are calculated once for all
+     * vocabulary words and stored as 32-bit thresholds indexed by the word index, so a decision is one integer
+     * compare against random bits. Words which are never discarded have 0 threshold and need no random number.
+     * The object is shared by all train threads.
     */
     class downSampling_t {
     private:
-        const float m_sample;
-        const std::size_t m_trainWords;
-        const std::size_t m_unfrequentSince;
-        mutable std::uniform_real_distribution<float> m_freqWordsDistribution;
+        std::vector<uint32_t> m_thresholds;
 
     public:
         /**
@@ -29,29 +34,34 @@ namespace w2v {
          * @param _sample defines boundary of frequent words, small values (1e-5) make high boundary while
          * bigger values (1e-3) make low boundary
          * @param _trainWords defines total train words in a corpus
+         * @param _frequencies frequencies of vocabulary words, ordered by word index
          */
-        downSampling_t(float _sample, std::size_t _trainWords) :
-                m_sample(_sample), m_trainWords(_trainWords),
-                m_unfrequentSince(
-                        static_cast<std::size_t>((m_sample / (1.5f - 0.5f * std::sqrt(5.0f))) * m_trainWords)),
-                m_freqWordsDistribution(0.0f, 1.0f) {
+        downSampling_t(float _sample, std::size_t _trainWords, const std::vector<std::size_t> &_frequencies) :
+                m_thresholds(_frequencies.size(), 0) {
+            const auto unfrequentSince =
+                    static_cast<std::size_t>((_sample / (1.5f - 0.5f * std::sqrt(5.0f))) * _trainWords);
+            for (std::size_t i = 0; i < _frequencies.size(); ++i) {
+                if (_frequencies[i] > unfrequentSince) {
+                    // keep probability, the word is discarded if it is less than a uniform random value
+                    double z = static_cast<double>(_frequencies[i]) / _trainWords;
+                    double keep = (std::sqrt(z / _sample) + 1) * _sample / z;
+                    if (keep < 1.0) {
+                        m_thresholds[i] = static_cast<uint32_t>(
+                                std::min(4294967295.0, (1.0 - keep) * 4294967296.0));
+                    }
+                }
+            }
         }
 
         /**
-         * Generates a random decision to discard a word with _wordFreq frequency from a train sentence
-         * @param _wordFreq word frequency
+         * Generates a random decision to discard a word from a train sentence
+         * @param _index word index
          * @param _randomGenerator random generator object instantiated outside of the downSampling object
          * @returns skip (true) or include (false) word into a training sentence
          */
-        inline bool operator()(std::size_t _wordFreq, std::mt19937_64 &_randomGenerator) const noexcept {
-            if (_wordFreq > m_unfrequentSince) {
-                float z = ((float) _wordFreq) / m_trainWords;
-                float dist = (std::sqrt(z / m_sample) + 1) * m_sample / z;
-                auto ret = dist < m_freqWordsDistribution(_randomGenerator);
-                return ret;
-            }
-
-            return false;
+        inline bool operator()(std::size_t _index, randomGenerator_t &_randomGenerator) const noexcept {
+            const uint32_t threshold = m_thresholds[_index];
+            return (threshold != 0) && (static_cast<uint32_t>(_randomGenerator() >> 32U) < threshold);
         }
     };
 }
@@ -0,0 +1,435 @@
+/**
+ * @file
+ * @brief gzipReader class - parallel decompression of gzip train data files into a bounded queue of text blocks
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef W2V_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "gzipReader.hpp"
+
+namespace w2v {
+#ifdef W2V_WITH_ZLIB
+    namespace {
+        const std::size_t blockSize = 4 * 1024 * 1024; // decoded text block size
+        const std::size_t verifiedSize = 1024 * 1024; // decoded size of a found member which makes it trusted
+        const std::size_t noHeader = static_cast<std::size_t>(-1);
+
+        /// @returns true if a gzip member may start at _data: ID1, ID2, CM = deflate, reserved FLG bits are 0
+        inline bool header(const uint8_t *_data, std::size_t _left) noexcept {
+            return (_left >= 20) && (_data[0] == 0x1fU) && (_data[1] == 0x8bU) && (_data[2] == 8U)
+                   && ((_data[3] & 0xe0U) == 0);
+        }
+
+        /// zlib inflate stream of gzip members
+        struct inflater_t final {
+            z_stream stream;
+
+            inflater_t(): stream() {
+                if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+                    throw std::runtime_error("gzipReader: zlib initialization failed");
+                }
+            }
+            ~inflater_t() {inflateEnd(&stream);}
+
+            inflater_t(const inflater_t &) = delete;
+            void operator=(const inflater_t &) = delete;
+        };
+    }
+#endif
+
+    gzipReader_t::gzipReader_t(const corpus_t &_corpus, const delimiterScanner_t &_scanner,
+                               std::size_t _threads, std::size_t _consumers, std::size_t _capacity,
+                               std::size_t _rangeSize):
+            m_corpus(_corpus), m_scanner(_scanner), m_tasks(), m_nextTask(0), m_processed(0),
+            m_capacity(std::max<std::size_t>(1, _capacity)), m_consumers(std::max<std::size_t>(1, _consumers)),
+            m_lock(), m_notFull(), m_notEmpty(), m_queue(), m_nextBlock(), m_word(), m_error(), m_threads() {
+#ifdef W2V_WITH_ZLIB
+        for (std::size_t f = 0; f < m_corpus.compressedFiles(); ++f) {
+            const auto size = static_cast<std::size_t>(m_corpus.compressedFile(f).size());
+            const std::size_t ranges = std::max<std::size_t>(1, size / std::max<std::size_t>(1, _rangeSize));
+            for (std::size_t r = 0; r < ranges; ++r) {
+                task_t task;
+                task.file = f;
+                task.from = size / ranges * r;
+                task.to = (r + 1 == ranges) ? size : size / ranges * (r + 1);
+                m_tasks.push_back(std::move(task));
+            }
+        }
+        for (std::size_t i = 0; i < m_consumers; ++i) {
+            m_nextBlock.push_back(i);
+        }
+
+        const std::size_t threads = std::max<std::size_t>(1, std::min(_threads, m_tasks.size()));
+        try {
+            for (std::size_t i = 0; i < threads; ++i) {
+                m_threads.emplace_back([this]() {decode();});
+            }
+        } catch (...) {
+            stop();
+            for (auto &i:m_threads) {
+                i.join();
+            }
+            throw;
+        }
+#else
+        (void) _threads;
+        (void) _rangeSize;
+        throw std::runtime_error("gzipReader: compressed train data is not supported, "
+                                 "the library is built without zlib");
+#endif
+    }
+
+    gzipReader_t::~gzipReader_t() {
+        stop();
+        for (auto &i:m_threads) {
+            i.join();
+        }
+    }
+
+    void gzipReader_t::stop() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopped = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    bool gzipReader_t::next(std::size_t _consumer, std::string &_block) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        auto &sequence = m_nextBlock[_consumer];
+        while (true) {
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+            if (m_stopped) {
+                return false;
+            }
+            try {
+                if (collect()) {
+                    // queued blocks may be dealt to the other threads, decoders may add blocks of the current range
+                    m_notFull.notify_all();
+                    m_notEmpty.notify_all();
+                }
+            } catch (...) {
+                m_error = std::current_exception();
+                m_stopped = true;
+                m_notFull.notify_all();
+                m_notEmpty.notify_all();
+                throw;
+            }
+            if (sequence < m_queueBase + m_queue.size()) {
+                break;
+            }
+            if (m_current == m_tasks.size()) {
+                return false;
+            }
+            m_notEmpty.wait(lock);
+        }
+        _block = std::move(m_queue[sequence - m_queueBase]);
+        sequence += m_consumers;
+        // blocks are released in order, once the threads they are dealt to have taken them
+        while (!m_queue.empty() && (m_queueBase < m_nextBlock[m_queueBase % m_consumers])) {
+            m_queue.pop_front();
+            ++m_queueBase;
+        }
+        // the released space is filled by the next blocks in the other threads calls
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+        return true;
+    }
+
+    void gzipReader_t::push(std::size_t _index, std::string &&_block) {
+        if (_block.empty()) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_lock);
+        // blocks of the current range are taken soon, blocks decoded ahead of it wait in the reorder window
+        m_notFull.wait(lock, [this, _index]() {
+            return m_stopped || ((_index == m_current) ? (m_tasks[_index].blocks.size() < m_capacity)
+                                                       : (m_buffered < m_capacity));
+        });
+        if (m_stopped) {
+            return;
+        }
+        m_tasks[_index].blocks.push_back(std::move(_block));
+        if (_index != m_current) {
+            ++m_buffered;
+        }
+        m_notEmpty.notify_all();
+    }
+
+    void gzipReader_t::enqueue(std::string &&_block) {
+        if (!_block.empty()) {
+            m_queue.push_back(std::move(_block));
+        }
+    }
+
+    bool gzipReader_t::collect() {
+        bool ret = false;
+        while ((m_queue.size() < m_capacity) && (m_current < m_tasks.size())) {
+            auto &task = m_tasks[m_current];
+            if (!m_headQueued) {
+                // the first word of a range ends the last word of the previous range
+                if (!task.split && !task.finished) {
+                    break;
+                }
+                m_word += task.head;
+                std::string().swap(task.head);
+                if (task.split) {
+                    enqueue(std::move(m_word));
+                    m_word.clear();
+                }
+                m_headQueued = true;
+            }
+            if (!task.blocks.empty()) {
+                enqueue(std::move(task.blocks.front()));
+                task.blocks.pop_front();
+                ret = true;
+                continue;
+            }
+            if (!task.finished) {
+                break;
+            }
+
+            if (task.decoded) {
+                if (task.start != m_chainEnd) {
+                    throw std::runtime_error(std::string("gzipReader: ") + m_corpus.compressedName(task.file)
+                                             + " - corrupted data");
+                }
+                m_chainEnd = task.end;
+            }
+            if (task.split) {
+                m_word = std::move(task.tail);
+            }
+            if ((m_current + 1 == m_tasks.size()) || (m_tasks[m_current + 1].file != task.file)) {
+                // garbage after the last member is ignored like gzip does, but not a member which is not decoded
+                const auto &file = m_corpus.compressedFile(task.file);
+                const auto size = static_cast<std::size_t>(file.size());
+                if ((m_chainEnd + 1 < size) && (static_cast<uint8_t>(file.data()[m_chainEnd]) == 0x1fU)
+                    && (static_cast<uint8_t>(file.data()[m_chainEnd + 1]) == 0x8bU)) {
+                    throw std::runtime_error(std::string("gzipReader: ") + m_corpus.compressedName(task.file)
+                                             + " - corrupted data");
+                }
+                // the end of a file is the end of a word
+                enqueue(std::move(m_word));
+                m_word.clear();
+                m_chainEnd = 0;
+            }
+
+            // blocks of the next range leave the reorder window
+            ++m_current;
+            m_headQueued = false;
+            if (m_current < m_tasks.size()) {
+                m_buffered -= m_tasks[m_current].blocks.size();
+            }
+            ret = true;
+        }
+        return ret;
+    }
+
+    void gzipReader_t::decode() noexcept {
+        try {
+            for (auto i = m_nextTask.fetch_add(1); i < m_tasks.size(); i = m_nextTask.fetch_add(1)) {
+                decode(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+            m_stopped = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    void gzipReader_t::decode(std::size_t _index) {
+#ifdef W2V_WITH_ZLIB
+        auto &task = m_tasks[_index];
+        const auto data = reinterpret_cast<const uint8_t *>(m_corpus.compressedFile(task.file).data());
+        const auto size = static_cast<std::size_t>(m_corpus.compressedFile(task.file).size());
+        const auto &name = m_corpus.compressedName(task.file);
+        std::string text; // decoded text which is not pushed yet
+        std::string unverified; // decoded text of a found member which is not trusted yet
+        std::vector<char> output(256 * 1024);
+        inflater_t inflater;
+        auto &stream = inflater.stream;
+
+        // cuts decoded text into blocks, the first and the last words of the range are kept to be joined
+        auto cut = [&](bool _final) {
+            if (!task.split) {
+                auto first = static_cast<std::size_t>(m_scanner.find(text.data(), text.data() + text.size())
+                                                      - text.data());
+                if (first == text.size()) {
+                    if (_final) {
+                        task.head.swap(text);
+                        text.clear();
+                    }
+                    return;
+                }
+                {
+                    // the head is joined as soon as it is known, before the blocks of the range
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    task.head.assign(text, 0, first);
+                    task.split = true;
+                }
+                m_notEmpty.notify_all();
+                text.erase(0, first);
+            }
+            if (!_final && (text.size() < blockSize)) {
+                return;
+            }
+            auto end = text.size();
+            while ((end > 0) && (m_scanner.charClass(text[end - 1]) == delimiterScanner_t::WORD_CHAR)) {
+                --end;
+            }
+            if (_final) {
+                task.tail.assign(text, end, std::string::npos);
+                text.resize(end);
+                push(_index, std::move(text));
+                text.clear();
+                return;
+            }
+            // a block ends after the last end of sentence if there is one
+            auto eos = end;
+            while ((eos > 0) && (m_scanner.charClass(text[eos - 1]) != delimiterScanner_t::END_OF_SENTENCE)) {
+                --eos;
+            }
+            if (eos > 0) {
+                end = eos;
+            }
+            push(_index, std::string(text, 0, end));
+            text.erase(0, end);
+        };
+
+        // decodes a member, returns its end or 0 if a found member is not valid
+        auto member = [&](std::size_t _from, bool _trusted) -> std::size_t {
+            if (inflateReset(&stream) != Z_OK) {
+                throw std::runtime_error(std::string("gzipReader: ") + name + " - zlib error");
+            }
+            unverified.clear();
+            bool verified = _trusted;
+            std::size_t in = _from;
+            stream.avail_in = 0;
+            int ret = Z_OK;
+            while (ret != Z_STREAM_END) {
+                if (stream.avail_in == 0) {
+                    auto slice = std::min<std::size_t>(size - in, 1U << 30U);
+                    if (slice == 0) {
+                        break; // truncated member
+                    }
+                    stream.next_in = const_cast<Bytef *>(data + in);
+                    stream.avail_in = static_cast<uInt>(slice);
+                    in += slice;
+                }
+                stream.next_out = reinterpret_cast<Bytef *>(output.data());
+                stream.avail_out = static_cast<uInt>(output.size());
+                ret = inflate(&stream, Z_NO_FLUSH);
+                if ((ret != Z_OK) && (ret != Z_STREAM_END) && !((ret == Z_BUF_ERROR) && (stream.avail_in == 0))) {
+                    break;
+                }
+                const auto decoded = output.size() - stream.avail_out;
+                if (verified) {
+                    text.append(output.data(), decoded);
+                    cut(false);
+                } else {
+                    unverified.append(output.data(), decoded);
+                    if (unverified.size() >= verifiedSize) {
+                        verified = true;
+                        text += unverified;
+                        unverified.clear();
+                        cut(false);
+                    }
+                }
+            }
+            if (ret != Z_STREAM_END) {
+                if (verified) {
+                    throw std::runtime_error(std::string("gzipReader: ") + name + " - "
+                                             + ((stream.msg != nullptr) ? stream.msg : "unexpected end of file"));
+                }
+                return 0;
+            }
+            if (!verified) {
+                text += unverified;
+                unverified.clear();
+                cut(false);
+            }
+            const auto end = in - stream.avail_in;
+            m_processed.fetch_add(end - _from, std::memory_order_relaxed);
+            return end;
+        };
+
+        // searches for a member header in [_from, _to)
+        auto search = [&](std::size_t _from, std::size_t _to) -> std::size_t {
+            for (auto pos = _from; pos < _to; ++pos) {
+                auto found = static_cast<const uint8_t *>(std::memchr(data + pos, 0x1f, _to - pos));
+                if (found == nullptr) {
+                    break;
+                }
+                pos = static_cast<std::size_t>(found - data);
+                if (header(data + pos, size - pos)) {
+                    return pos;
+                }
+            }
+            return noHeader;
+        };
+
+        // remembers the decoded members bounds, they are checked for gaps by joinTasks()
+        auto decoded = [&](std::size_t _from, std::size_t _end) {
+            if (!task.decoded) {
+                task.decoded = true;
+                task.start = _from;
+            } else if (task.end != _from) {
+                throw std::runtime_error(std::string("gzipReader: ") + name + " - corrupted data");
+            }
+            task.end = _end;
+        };
+
+        // a member following a decoded one is trusted, a member found by search is verified
+        const auto to = std::min(task.to, size);
+        auto pos = task.from;
+        bool trusted = (pos == 0);
+        while (pos < to) {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_stopped) {
+                    return;
+                }
+            }
+            if (trusted && header(data + pos, size - pos)) {
+                const auto end = member(pos, true);
+                decoded(pos, end);
+                pos = end;
+                continue;
+            }
+            auto found = search(pos, to);
+            if (found == noHeader) {
+                break;
+            }
+            auto end = member(found, false);
+            trusted = (end != 0);
+            if (trusted) {
+                decoded(found, end);
+            }
+            pos = trusted ? end : found + 1;
+        }
+        cut(true);
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            task.finished = true;
+        }
+        m_notEmpty.notify_all();
+#else
+        (void) _index;
+#endif
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief gzipReader class - parallel decompression of gzip train data files into a bounded queue of text blocks
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_GZIPREADER_H
+#define WORD2VEC_GZIPREADER_H
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wordReader.hpp"
+#include "corpus.hpp"
+
+namespace w2v {
+    /**
+     * @brief gzipReader class - parallel decompression of gzip train data files into a bounded queue of text blocks
+     *
+     * Compressed files of a corpus are decoded by dedicated threads, decoded text is cut into blocks at sentence ends
+     * or word delimiters and passed to the parsing threads through a queue of a limited size, so decompression and
+     * parsing run at the same time and only a few blocks are kept in memory. Blocks are queued in the order of the
+     * files text, blocks decoded ahead of it wait in a reorder window of the same limited size. Queued blocks are
+     * dealt to the parsing threads round-robin, so every thread gets the same text in every run.
+     * A file is divided into byte ranges decoded by different threads. A gzip file of many members (concatenated
+     * gzip streams, like bgzip or pigz --independent output) is decoded in parallel: a thread searches its range for
+     * the next member header and decodes members starting in its range, the last one is decoded to its end. A found
+     * header may be a part of compressed data, so output of such a member is not used until the member is decoded
+     * with the correct checksum or 1MB of it is decoded successfully. A single member file is decoded by one thread.
+     * Parts of words cut by range bounds are joined when blocks are queued, the decoded members of a file must
+     * follow each other without gaps, so a corrupted member is never skipped silently.
+    */
+    class gzipReader_t final {
+    private:
+        /// byte range of a compressed file
+        struct task_t final {
+            std::size_t file = 0; ///< compressed file index, see corpus_t::compressedFile()
+            std::size_t from = 0; ///< range start, the first member starting at or after it is decoded
+            std::size_t to = 0; ///< range end, members starting at or after it are decoded by the next range
+            std::string head; ///< decoded text before the first word delimiter, a part of the previous range word
+            std::string tail; ///< decoded text after the last word delimiter, a part of the next range word
+            bool split = false; ///< is a word delimiter found? If not, the whole decoded text is in head
+            bool decoded = false; ///< is a member decoded?
+            std::size_t start = 0; ///< start of the first decoded member
+            std::size_t end = 0; ///< end of the last decoded member
+            std::deque<std::string> blocks; ///< decoded blocks waiting to be queued in order
+            bool finished = false; ///< are all members starting in the range decoded?
+        };
+
+        const corpus_t &m_corpus;
+        const delimiterScanner_t m_scanner;
+        std::vector<task_t> m_tasks;
+        std::atomic<std::size_t> m_nextTask;
+        std::atomic<std::size_t> m_processed; // compressed bytes decoded
+        const std::size_t m_capacity; // max blocks in the queue, in the reorder window and of the current range
+        const std::size_t m_consumers; // parsing threads number
+
+        std::mutex m_lock;
+        std::condition_variable m_notFull;
+        std::condition_variable m_notEmpty;
+        std::deque<std::string> m_queue; // blocks in the order of the files text
+        std::size_t m_queueBase = 0; // sequence number of the first block of the queue
+        std::vector<std::size_t> m_nextBlock; // sequence number of the next block of each parsing thread
+        std::size_t m_current = 0; // range whose blocks are queued now
+        bool m_headQueued = false; // is the head of the current range joined?
+        std::size_t m_buffered = 0; // blocks of the ranges after the current one, the reorder window
+        std::string m_word; // a word cut by range bounds
+        std::size_t m_chainEnd = 0; // end of the members queued so far in the current file
+        bool m_stopped = false;
+        std::exception_ptr m_error;
+        std::vector<std::thread> m_threads;
+
+        /// decoding thread, claims ranges one by one
+        void decode() noexcept;
+        /// decodes members starting in the range
+        void decode(std::size_t _index);
+        /// adds a non-empty block of the range, waits while the range is not current and the reorder window is full
+        void push(std::size_t _index, std::string &&_block);
+        /// adds a non-empty block to the queue
+        void enqueue(std::string &&_block);
+        /**
+         * Moves blocks of the current range to the queue while the queue is not full, joins parts of words cut by
+         * range bounds and checks decoded members follow each other without gaps. Called under the lock.
+         * @returns true if the queue or the current range is changed
+         * @throws std::runtime_error In case of corrupted compressed data
+        */
+        bool collect();
+
+    public:
+        /**
+         * Starts decompression of the compressed files of the corpus
+         * @param _corpus train data
+         * @param _scanner delimiter chars scanner
+         * @param _threads decoding threads number
+         * @param _consumers parsing threads number, see next()
+         * @param _capacity max number of decoded blocks waiting in the queue, the same number of blocks may wait in
+         * the reorder window
+         * @param _rangeSize compressed bytes range claimed by a decoding thread
+         * @throws std::runtime_error if gzip support is not built
+        */
+        gzipReader_t(const corpus_t &_corpus, const delimiterScanner_t &_scanner,
+                     std::size_t _threads, std::size_t _consumers, std::size_t _capacity,
+                     std::size_t _rangeSize = 16 * 1024 * 1024);
+        /// stops decompression
+        ~gzipReader_t();
+
+        /// stops decompression, next() returns false then, called by a parsing thread which fails to take its blocks
+        void stop() noexcept;
+
+        // copying prohibited
+        gzipReader_t(const gzipReader_t &) = delete;
+        void operator=(const gzipReader_t &) = delete;
+
+        /**
+         * Takes the next decoded block of a parsing thread, waits until it is queued. Called by many threads at the
+         * same time, the _consumer-th thread takes blocks _consumer, _consumer + consumers, ... of the queue.
+         * @param _consumer parsing thread index, starting from 0
+         * @param[out] _block decoded text block, it is never empty and it never ends inside a word
+         * @returns false if all files are decoded and all blocks of the thread are taken
+         * @throws std::runtime_error In case of corrupted compressed data
+        */
+        bool next(std::size_t _consumer, std::string &_block);
+
+        /// @returns compressed bytes decoded so far
+        inline std::size_t processed() const noexcept {return m_processed.load(std::memory_order_relaxed);}
+    };
+}
+
+#endif // WORD2VEC_GZIPREADER_H
@@ -1,55 +1,94 @@
 /**
  * @file
- * @brief Huffman encoding tree implementation based on std::priority_queue
+ * @brief Huffman encoding tree implementation based on two queues of sorted nodes
  * @author Max Fomichev
  * @date 19.12.2016
  * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
 */
 
-#include <vector>
-#include <queue>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
 
 #include "huffmanTree.hpp"
 
 namespace w2v {
-    void huffmanTree_t::buildTree(const std::vector<std::size_t> &_input, std::shared_ptr<node_t> &_tree) const {
-        std::priority_queue<std::shared_ptr<node_t>, std::vector<std::shared_ptr<node_t>>, nodeCmp_t> tree;
+    huffmanTree_t::huffmanTree_t(const std::vector<std::size_t> &_input): m_offsets(), m_points(), m_codes() {
+        const std::size_t leaves = _input.size();
+        if (leaves == 0) {
+            return;
+        }
+        if (leaves > UINT32_MAX / 2) {
+            throw std::runtime_error("huffmanTree: too many input values");
+        }
+
+        // input indexes in ascending frequency order. Vocabulary indexes are sorted from more frequent to less
+        // frequent except the first one (sentence delimiter), so it is enough to reverse them and insert the first.
+        std::vector<uint32_t> order(leaves);
+        std::iota(order.rbegin() + 1, order.rend(), 1U);
+        auto freqCmp = [&_input](uint32_t _what, uint32_t _with) {
+            return _input[_what] < _input[_with];
+        };
+        auto first = std::upper_bound(order.begin(), order.end() - 1, 0U, freqCmp);
+        std::copy_backward(first, order.end() - 1, order.end());
+        *first = 0;
+        if (!std::is_sorted(order.begin(), order.end(), freqCmp)) {
+            std::stable_sort(order.begin(), order.end(), freqCmp);
+        }
 
-        for (std::size_t i = 0; i < _input.size(); ++i) {
-            tree.emplace(std::shared_ptr<leaf_t>(new leaf_t(i, _input[i])));
+        // nodes [0, leaves) are leaves in order, nodes [leaves, 2 * leaves - 1) are branches in creation order
+        const std::size_t nodes = leaves * 2 - 1;
+        std::vector<std::size_t> frequency(nodes, 0);
+        std::vector<uint32_t> parent(nodes, 0);
+        std::vector<uint8_t> binary(nodes, 0);
+        for (std::size_t i = 0; i < leaves; ++i) {
+            frequency[i] = _input[order[i]];
+        }
+        // the first queue is leaves, the second one is branches, both are sorted, so the smallest node is at the
+        // head of one of them
+        std::size_t leafPos = 0;
+        std::size_t branchPos = leaves;
+        auto popMin = [&](std::size_t _branchEnd) {
+            if ((leafPos < leaves)
+                && ((branchPos >= _branchEnd) || (frequency[leafPos] <= frequency[branchPos]))) {
+                return leafPos++;
+            }
+            return branchPos++;
+        };
+        for (std::size_t branch = leaves; branch < nodes; ++branch) {
+            auto left = popMin(branch);
+            auto right = popMin(branch);
+            frequency[branch] = frequency[left] + frequency[right];
+            parent[left] = static_cast<uint32_t>(branch);
+            parent[right] = static_cast<uint32_t>(branch);
+            binary[right] = 1;
         }
-        std::size_t branchID = 0;
-        while (tree.size() > 1) {
-            std::shared_ptr<node_t> left = tree.top();
-            tree.pop();
 
-            std::shared_ptr<node_t> right = tree.top();
-            tree.pop();
+        // a parent is always created after its children, so depths are calculated from the root down
+        std::vector<uint32_t> depth(nodes, 0);
+        for (std::size_t i = nodes - 1; i-- > 0;) {
+            depth[i] = depth[parent[i]] + 1;
+        }
 
-            tree.emplace(std::shared_ptr<branch_t>(new branch_t(left, right, branchID++)));
+        m_offsets.resize(leaves + 1);
+        m_offsets[0] = 0;
+        for (std::size_t i = 0; i < leaves; ++i) {
+            m_offsets[order[i] + 1] = depth[i];
         }
-        _tree = tree.top();
-        tree.pop();
-    }
+        for (std::size_t i = 1; i <= leaves; ++i) {
+            m_offsets[i] += m_offsets[i - 1];
+        }
+        m_points.resize(m_offsets[leaves]);
+        m_codes.resize((m_offsets[leaves] + 63) / 64, 0);
 
-    void huffmanTree_t::generateCodes(const std::shared_ptr<node_t> &_node,
-                       const huffmanCode_t &_code,
-                       const huffmanPoint_t &_point) {
-        if (const leaf_t *leaf = dynamic_cast<const leaf_t *>(_node.get())) {
-            m_tree[leaf->m_index] = huffmanData_t(_code, _point);
-
-        }  else if (const branch_t *branch = dynamic_cast<const branch_t *>(_node.get())) {
-            auto leftPrefix = _code;
-            leftPrefix.push_back(false);
-            auto leftPoint = _point;
-            leftPoint.push_back(branch->m_id);
-            generateCodes(branch->m_left, leftPrefix, leftPoint);
-
-            auto rightPrefix = _code;
-            rightPrefix.push_back(true);
-            auto rightPoint = _point;
-            rightPoint.push_back(branch->m_id);
-            generateCodes(branch->m_right, rightPrefix, rightPoint);
+        // codes are written from the leaf up to the root
+        for (std::size_t i = 0; i < leaves; ++i) {
+            auto pos = m_offsets[order[i] + 1];
+            for (auto node = i; node != nodes - 1; node = parent[node]) {
+                --pos;
+                m_points[pos] = static_cast<uint32_t>(parent[node] - leaves);
+                m_codes[pos >> 6U] |= static_cast<uint64_t>(binary[node]) << (pos & 63U);
+            }
         }
     }
-}
\ No newline at end of file
+}
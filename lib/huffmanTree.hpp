@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief Huffman encoding tree implementation based on std::priority_queue
+ * @brief Huffman encoding tree implementation based on two queues of sorted nodes
  * @author Max Fomichev
  * @date 19.12.2016
  * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
@@ -9,100 +9,42 @@
 #ifndef WORD2VEC_HUFFMANTREE_H
 #define WORD2VEC_HUFFMANTREE_H
 
-#include <memory>
+#include <cstdint>
+#include <vector>
 
 namespace w2v {
     /**
-     * @brief huffmanTree class - Huffman encoding tree implementation based on std::priority_queue
+     * @brief huffmanTree class - Huffman encoding tree implementation based on two queues of sorted nodes
      *
      * Input for a huffmanTree object is a vector of frequencies where vector index is the key and value is frequency
-     * corresponding to the key. Output is a tree node with binary code (huffmanCode_t) and neighbors branch
-     * IDs (huffmanPoint_t)
+     * corresponding to the key. Output is a binary code and parent branch IDs of the key (huffmanData_t).
+     * Leaves are taken in ascending frequency order and new branches are created in ascending frequency order too,
+     * so the tree is built in linear time with two FIFO queues when frequencies are already sorted (the vocabulary
+     * indexes words from more frequent to less frequent).
+     * The tree itself is not stored. All codes are stored in a flat structure of arrays - one contiguous buffer of
+     * 32 bit branch IDs, one packed bit buffer of code bits sharing the same positions, and per key offsets.
      * Read more - https://mitpress.mit.edu/sicp/full-text/sicp/book/node41.html
     */
     class huffmanTree_t final {
     public:
-        using huffmanCode_t = std::vector<bool>; ///< huffman binary code type
-        using huffmanPoint_t = std::vector<std::size_t>; ///< huffman parent branch IDs type
-        /// Huffman tree output data structure
+        /// Huffman tree output data, a view of the tree storage
         struct huffmanData_t final {
-            huffmanCode_t huffmanCode; ///< Huffman binary code
-            huffmanPoint_t huffmanPoint; ///< Huffman tree parent branch IDs
-
-            /// Constructs an empty object
-            huffmanData_t() = default;
-            /// Constructs an object with _huffmanCode and _huffmanPoint
-            huffmanData_t(const huffmanCode_t &_huffmanCode,
-                          const huffmanPoint_t &_huffmanPoint):
-                    huffmanCode(_huffmanCode), huffmanPoint(_huffmanPoint) {}
-        };
-
-    private:
-        /// Encoding tree node, base class
-        class node_t  {
-        public:
-            const std::size_t m_frequency; ///< frequency value
-
-        public:
-            virtual ~node_t() = default;
-
-            // copying prohibited
-            node_t(const node_t &) = delete;
-            void operator=(const node_t &) = delete;
-
-        protected:
-            explicit node_t(std::size_t _frequency): m_frequency(_frequency) {}
-        };
-
-        /// Structure to compare tree nodes
-        struct nodeCmp_t final {
-            inline bool operator()(const std::shared_ptr<node_t> &_left,
-                                   const std::shared_ptr<node_t> &_right) const noexcept {
-                return _left->m_frequency > _right->m_frequency;
+            const uint32_t *points = nullptr; ///< Huffman tree parent branch IDs, from the root
+            const uint64_t *codes = nullptr; ///< packed Huffman binary codes storage
+            std::size_t codesShift = 0; ///< position of the first code bit in the codes storage
+            std::size_t length = 0; ///< Huffman binary code length
+
+            /// @returns _i-th bit of the Huffman binary code
+            inline bool code(std::size_t _i) const noexcept {
+                auto bit = codesShift + _i;
+                return ((codes[bit >> 6U] >> (bit & 63U)) & 1U) != 0;
             }
         };
 
-        /// Encoding tree branch
-        class branch_t final: public node_t {
-        public:
-            const std::shared_ptr<node_t> m_left; ///< left node
-            const std::shared_ptr<node_t> m_right; ///< right node
-            const std::size_t m_id; ///< branch ID
-
-            /**
-             * Constructs a branch object with neighbor nodes and unique ID
-             * @param _left left node
-             * @param _right right node
-             * @param _id unique branch ID
-             */
-            branch_t(const std::shared_ptr<node_t> &_left,
-                     const std::shared_ptr<node_t> &_right,
-                     std::size_t _id):
-                    node_t(_left->m_frequency + _right->m_frequency), m_left(_left), m_right(_right), m_id(_id) {}
-
-            // copying prohibited
-            branch_t(const branch_t &) = delete;
-            void operator=(const branch_t &) = delete;
-        };
-
-        /// Encoding tree leaf
-        class leaf_t final: public node_t {
-        public:
-            const std::size_t m_index; ///< input vector index (key of frequency value)
-
-            /**
-             * Constructs a leaf with input index and frequency
-             * @param _index input vector index
-             * @param _frequency input frequency of the _index element
-             */
-            leaf_t(std::size_t _index, std::size_t _frequency): node_t(_frequency), m_index(_index) {}
-
-            // copying prohibited
-            leaf_t(const leaf_t &) = delete;
-            void operator=(const leaf_t &) = delete;
-        };
-
-        std::vector<huffmanData_t> m_tree; ///< Huffman tree (vector) where m_tree indexes are input vector indexes
+    private:
+        std::vector<std::size_t> m_offsets; ///< code positions of input indexes, m_offsets[i + 1] is the end of i-th
+        std::vector<uint32_t> m_points; ///< parent branch IDs of all codes
+        std::vector<uint64_t> m_codes; ///< packed bits of all codes
 
     public:
         /**
@@ -110,11 +52,7 @@ namespace w2v {
          * @param _input Input vector of frequencies to be encoded
          * @throws std::exception in case of a member initialisztion or tree building failed
          */
-        explicit huffmanTree_t(const std::vector<std::size_t> &_input): m_tree(_input.size()) {
-            std::shared_ptr<node_t> tree;
-            buildTree(_input, tree);
-            generateCodes(tree, huffmanCode_t(), huffmanPoint_t());
-        }
+        explicit huffmanTree_t(const std::vector<std::size_t> &_input);
 
         // copying prohibited
         huffmanTree_t(const huffmanTree_t &) = delete;
@@ -123,23 +61,18 @@ namespace w2v {
         /**
          *
          * @param[in] _index frequency index
-         * @returns pointer to a huffmanData object with binary code and parent node IDs
+         * @returns huffmanData object with binary code and parent node IDs, empty one if _index is out of range
          */
-        inline const huffmanData_t *huffmanData(std::size_t _index) const noexcept {
-            if (_index < m_tree.size()) {
-                return &m_tree[_index];
-            } else {
-                return nullptr;
+        inline huffmanData_t huffmanData(std::size_t _index) const noexcept {
+            huffmanData_t ret;
+            if (_index + 1 < m_offsets.size()) {
+                ret.points = &m_points[m_offsets[_index]];
+                ret.codes = m_codes.data();
+                ret.codesShift = m_offsets[_index];
+                ret.length = m_offsets[_index + 1] - m_offsets[_index];
             }
+            return ret;
         }
-
-    private:
-        void buildTree(const std::vector<std::size_t> &_input,
-                       std::shared_ptr<node_t> &_tree) const;
-
-        void generateCodes(const std::shared_ptr<node_t> &_node,
-                           const huffmanCode_t &_code,
-                           const huffmanPoint_t &_point);
     };
 }
 
@@ -18,6 +18,7 @@
 #include <cerrno>
 #include <stdexcept>
 #include <cstring>
+#include <vector>
 
 #include "mapper.hpp"
 
@@ -62,8 +63,12 @@ namespace w2v {
                                                  m_fd, 0));
         if (m_data.rwData == static_cast<char *>(MAP_FAILED)) {
             std::string err = std::string("fileMapper: ") + _fileName + " - " + std::strerror(errno);
+            close(m_fd);
             throw std::runtime_error(err);
         }
+        // the mapping does not need the file descriptor, so many files of a corpus can be mapped at once
+        close(m_fd);
+        m_fd = -1;
     }
 
     fileMapper_t::~fileMapper_t() {
@@ -72,6 +77,32 @@ namespace w2v {
 #else
         munmap(reinterpret_cast<void *>(m_data.rwData), static_cast<size_t>(m_size));
 #endif
-        close(m_fd);
+    }
+
+    streamMapper_t::streamMapper_t(int _fd, const std::string &_name, uint64_t _maxSize): mapper_t(), m_buffer() {
+        std::vector<char> block(4 * 1024 * 1024);
+        while (true) {
+            auto bytes = ::read(_fd, block.data(), block.size());
+            if (bytes < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("streamMapper: ") + _name + " - " + std::strerror(errno));
+            }
+            if (bytes == 0) {
+                break;
+            }
+            if (m_buffer.size() + static_cast<uint64_t>(bytes) > _maxSize) {
+                throw std::runtime_error(std::string("streamMapper: ") + _name + " is larger than "
+                                         + std::to_string(_maxSize >> 20U) + "MB, save it to a file and use the file");
+            }
+            m_buffer.append(block.data(), static_cast<std::size_t>(bytes));
+        }
+        if (m_buffer.empty()) {
+            throw std::runtime_error(std::string("streamMapper: ") + _name + " is empty, nothing to read");
+        }
+
+        m_data.roData = m_buffer.data();
+        m_size = static_cast<off_t>(m_buffer.size());
     }
 }
@@ -1,33 +1,67 @@
 /**
  * @file
- * @brief linear subintervals random distribution class
+ * @brief negative sampling distribution class - Walker/Vose alias table
  * @author Max Fomichev
  * @date 02.02.2017
  * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
 */
 
-#include <vector>
 #include <cmath>
+#include <stdexcept>
 
 #include "nsDistribution.hpp"
 
 namespace w2v {
-    nsDistribution_t::nsDistribution_t(const std::vector<std::size_t> &_input): m_nsDistribution() {
-        std::vector<std::size_t> intervals;
-        std::vector<std::size_t> weights;
-        std::size_t prvFreq = 0;
+    nsDistribution_t::nsDistribution_t(const std::vector<std::size_t> &_input): m_table() {
+        if (_input.size() < 2) {
+            throw std::runtime_error("nsDistribution: vocabulary is empty");
+        }
 
-        for (std::size_t i = 1; i < _input.size(); ++i) {
-            float rms = std::sqrt((prvFreq * prvFreq + _input[i] * _input[i]) / 2.0f);
-            if ((_input[i] < rms / 1.3f) || (_input[i] > rms * 1.3f)) {
-                intervals.push_back(i);
-                weights.push_back(static_cast<std::size_t>(std::pow(_input[i], 0.75)));
-                prvFreq = _input[i];
+        // sentence delimiter (index 0) is excluded, table entry i corresponds to the word index i + 1
+        m_table.resize(_input.size() - 1);
+        // probabilities scaled to the table size, so the average entry probability is 1.0
+        std::vector<double> probabilities(m_table.size(), 0.0);
+        double sum = 0.0;
+        for (std::size_t i = 0; i < m_table.size(); ++i) {
+            probabilities[i] = std::pow(static_cast<double>(_input[i + 1]), 0.75);
+            sum += probabilities[i];
+        }
+        for (auto &i:probabilities) {
+            i *= m_table.size() / sum;
+        }
+
+        // Vose's alias method: each underfull entry is topped up by an overfull one
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        for (std::size_t i = 0; i < probabilities.size(); ++i) {
+            if (probabilities[i] < 1.0) {
+                small.push_back(static_cast<uint32_t>(i));
+            } else {
+                large.push_back(static_cast<uint32_t>(i));
             }
         }
+        while (!small.empty() && !large.empty()) {
+            auto s = small.back();
+            small.pop_back();
+            auto l = large.back();
+
+            m_table[s].threshold = static_cast<uint32_t>(probabilities[s] * 4294967296.0);
+            m_table[s].alias = l;
 
-        m_nsDistribution.reset(new std::piecewise_linear_distribution<float>(intervals.begin(),
-                                                                             intervals.end(),
-                                                                             weights.begin()));
+            probabilities[l] -= 1.0 - probabilities[s];
+            if (probabilities[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // the rest entries are full (up to rounding errors), they always return themselves
+        for (auto i:large) {
+            m_table[i].threshold = UINT32_MAX;
+            m_table[i].alias = i;
+        }
+        for (auto i:small) {
+            m_table[i].threshold = UINT32_MAX;
+            m_table[i].alias = i;
+        }
     }
 }
@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief linear subintervals random distribution class
+ * @brief negative sampling distribution class - Walker/Vose alias table
  * @author Max Fomichev
  * @date 02.02.2017
  * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
@@ -9,33 +9,74 @@
 #ifndef WORD2VEC_NSDISTRIBUTION_H
 #define WORD2VEC_NSDISTRIBUTION_H
 
-#include <memory>
-#include <random>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "randomGenerator.hpp"
 
 namespace w2v {
     /**
-     * @brief nsDistribution class - linear subintervals random distribution
+     * @brief nsDistribution class - unigram^0.75 distribution of negative examples
      *
-     * Generates a random value based on a sequence of subintervals bounds with different probability densities.
+     * Generates word indexes with probabilities proportional to word frequencies powered 0.75. The distribution is
+     * exact and implemented as a Walker/Vose alias table, so each draw costs one random value, one multiplication
+     * and one table lookup. The object is immutable after construction and is shared by all train threads.
     */
     class nsDistribution_t final {
     private:
-        std::unique_ptr<std::piecewise_linear_distribution<float>> m_nsDistribution;
+        /// alias table entry, the entry index is chosen if a random value is less than threshold
+        struct entry_t final {
+            uint32_t threshold; ///< probability of the entry index scaled to 2^32
+            uint32_t alias; ///< alternative index
+        };
+
+        std::vector<entry_t> m_table;
 
     public:
         /**
-         * Constructs a nsDistribution object with approximated probability densities powered 0.75
-         * @param _input vector of probability densities for their indexes
+         * Constructs a nsDistribution object with probability densities powered 0.75
+         * @param _input vector of frequencies for their indexes, the first one (sentence delimiter) is ignored
          */
         explicit nsDistribution_t(const std::vector<std::size_t> &_input);
 
+        // copying prohibited
+        nsDistribution_t(const nsDistribution_t &) = delete;
+        void operator=(const nsDistribution_t &) = delete;
+
         /**
-         * Generates a random value inside of subintervals bounds
+         * Generates a random value
          * @param _randomGenerator random generator object instantiated outside of the nsDistribution object
-         * @returns a random value
+         * @returns a random word index
          */
-        inline std::size_t operator()(std::mt19937_64 &_randomGenerator) const noexcept {
-            return static_cast<std::size_t>((*m_nsDistribution)(_randomGenerator));
+        inline std::size_t operator()(randomGenerator_t &_randomGenerator) const noexcept {
+            return sample(_randomGenerator());
+        }
+
+        /**
+         * Generates a sequence of random values
+         * @param _n amount of values to be generated
+         * @param[out] _output buffer of at least _n elements
+         * @param _randomGenerator random generator object instantiated outside of the nsDistribution object
+         */
+        inline void draw(std::size_t _n, std::size_t *_output, randomGenerator_t &_randomGenerator) const noexcept {
+            // random values are generated in bulk by chunks, then mapped to word indexes
+            uint64_t values[64];
+            for (std::size_t i = 0; i < _n; i += 64) {
+                auto n = std::min<std::size_t>(_n - i, 64);
+                _randomGenerator.fill(values, n);
+                for (std::size_t j = 0; j < n; ++j) {
+                    _output[i + j] = sample(values[j]);
+                }
+            }
+        }
+
+    private:
+        inline std::size_t sample(uint64_t _rnd) const noexcept {
+            // high 32 bits select the table entry, low 32 bits select the entry index or its alias
+            auto index = static_cast<std::size_t>(((_rnd >> 32U) * m_table.size()) >> 32U);
+            const auto &entry = m_table[index];
+            return ((static_cast<uint32_t>(_rnd) < entry.threshold) ? index : entry.alias) + 1;
         }
     };
 }
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief NUMA topology, memory placement and threads affinity helpers
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <fstream>
+#include <string>
+
+#include "numa.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+namespace w2v {
+    std::size_t numa_t::nodes() noexcept {
+#ifdef __linux__
+        // online nodes list looks like "0-1" or "0,2-3", the number of nodes is the max node ID + 1
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        if (online && std::getline(online, list)) {
+            std::size_t ret = 0;
+            std::size_t value = 0;
+            bool digits = false;
+            for (auto ch:list) {
+                if ((ch >= '0') && (ch <= '9')) {
+                    value = value * 10 + static_cast<std::size_t>(ch - '0');
+                    digits = true;
+                } else {
+                    if (digits && (value + 1 > ret)) {
+                        ret = value + 1;
+                    }
+                    value = 0;
+                    digits = false;
+                }
+            }
+            if (digits && (value + 1 > ret)) {
+                ret = value + 1;
+            }
+            if (ret > 0) {
+                return ret;
+            }
+        }
+#endif
+        return 1;
+    }
+
+    std::size_t numa_t::cpuNode(uint16_t _cpu) noexcept {
+#ifdef __linux__
+        auto nodesNumber = nodes();
+        for (std::size_t i = 0; i < nodesNumber; ++i) {
+            struct stat fst{};
+            auto path = "/sys/devices/system/node/node" + std::to_string(i) + "/cpu" + std::to_string(_cpu);
+            if (stat(path.c_str(), &fst) == 0) {
+                return i;
+            }
+        }
+#else
+        (void) _cpu;
+#endif
+        return 0;
+    }
+
+    bool numa_t::pin(std::thread &_thread, uint16_t _cpu) noexcept {
+#ifdef __linux__
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(_cpu, &cpuSet);
+        return pthread_setaffinity_np(_thread.native_handle(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+        (void) _thread;
+        (void) _cpu;
+        return false;
+#endif
+    }
+
+    bool numa_t::interleave(void *_data, std::size_t _size) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+        auto nodesNumber = nodes();
+        if (nodesNumber < 2) {
+            return true;
+        }
+        const std::size_t maskBits = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> mask((nodesNumber + maskBits - 1) / maskBits, 0);
+        for (std::size_t i = 0; i < nodesNumber; ++i) {
+            mask[i / maskBits] |= 1UL << (i % maskBits);
+        }
+
+        // the range is extended to the page boundaries
+        const auto pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto from = reinterpret_cast<uintptr_t>(_data) & ~(pageSize - 1);
+        auto to = reinterpret_cast<uintptr_t>(_data) + _size;
+        const int mpolInterleave = 3; // MPOL_INTERLEAVE
+        return syscall(SYS_mbind, from, to - from, mpolInterleave, mask.data(), nodesNumber + 1, 0) == 0;
+#else
+        (void) _data;
+        (void) _size;
+        return false;
+#endif
+    }
+
+    void numa_t::pages(const void *_data, std::size_t _size, std::vector<std::size_t> &_pages) noexcept {
+        if (_pages.size() < nodes()) {
+            _pages.resize(nodes(), 0);
+        }
+#if defined(__linux__) && defined(SYS_move_pages)
+        // move_pages() without target nodes only reports the current node of each page
+        const auto pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto from = reinterpret_cast<uintptr_t>(_data) & ~(pageSize - 1);
+        auto to = reinterpret_cast<uintptr_t>(_data) + _size;
+        const std::size_t batchSize = 4096;
+        std::vector<void *> pages(batchSize);
+        std::vector<int> status(batchSize);
+        for (auto page = from; page < to;) {
+            std::size_t count = 0;
+            for (; (count < batchSize) && (page < to); ++count, page += pageSize) {
+                pages[count] = reinterpret_cast<void *>(page);
+            }
+            if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0) {
+                return;
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                if ((status[i] >= 0) && (static_cast<std::size_t>(status[i]) < _pages.size())) {
+                    _pages[static_cast<std::size_t>(status[i])]++;
+                }
+            }
+        }
+#else
+        (void) _data;
+        (void) _size;
+#endif
+    }
+}
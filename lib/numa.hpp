@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief NUMA topology, memory placement and threads affinity helpers
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_NUMA_H
+#define WORD2VEC_NUMA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace w2v {
+    /**
+     * @brief numa structure - NUMA topology, memory placement and threads affinity helpers
+     *
+     * Linux kernel interfaces are used directly (sysfs, pthread affinity, mbind and move_pages system calls), so
+     * there is no libnuma dependency. On other systems there is one node and placement helpers do nothing.
+    */
+    struct numa_t final {
+        /// @returns number of NUMA nodes, 1 if it is unknown
+        static std::size_t nodes() noexcept;
+
+        /// @returns NUMA node of the _cpu, 0 if it is unknown
+        static std::size_t cpuNode(uint16_t _cpu) noexcept;
+
+        /**
+         * Pins a thread to the CPU
+         * @param _thread running thread
+         * @param _cpu CPU number
+         * @returns true on success
+        */
+        static bool pin(std::thread &_thread, uint16_t _cpu) noexcept;
+
+        /**
+         * Sets interleaved over all NUMA nodes placement policy of a memory range. Pages which are already touched
+         * are not moved.
+         * @param _data start of the memory range
+         * @param _size size of the memory range in bytes
+         * @returns true on success
+        */
+        static bool interleave(void *_data, std::size_t _size) noexcept;
+
+        /**
+         * Counts memory pages of a memory range by their NUMA nodes
+         * @param _data start of the memory range
+         * @param _size size of the memory range in bytes
+         * @param[in,out] _pages pages counters, _pages[i] is increased by pages number of the i-th node, vector is
+         * resized to nodes() if it is smaller. Pages which are not touched yet are not counted.
+        */
+        static void pages(const void *_data, std::size_t _size, std::vector<std::size_t> &_pages) noexcept;
+    };
+}
+
+#endif // WORD2VEC_NUMA_H
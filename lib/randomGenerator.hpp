@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @brief small-state pseudo random generator with bulk generation
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+#ifndef WORD2VEC_RANDOMGENERATOR_H
+#define WORD2VEC_RANDOMGENERATOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+namespace w2v {
+    /**
+     * @brief randomGenerator class - xoshiro256 family pseudo random generator
+     *
+     * Scalar values are generated by xoshiro256** (http://prng.di.unimi.it), bulk values are generated by
+     * independent interleaved xoshiro256+ lanes, so the bulk generation loop is vectorized by compiler.
+     * The generator satisfies UniformRandomBitGenerator requirements and can be used with std distributions.
+     * Uniform floats and bounded integers are produced without divisions.
+    */
+    class randomGenerator_t final {
+    public:
+        using result_type = uint64_t;
+
+    private:
+        static const std::size_t lanes = 8;
+
+        uint64_t m_state[4]; // scalar generator state
+        uint64_t m_laneState[4][lanes]; // bulk generator state, one column per lane
+
+        static inline uint64_t rotl(uint64_t _x, unsigned int _k) noexcept {
+            return (_x << _k) | (_x >> (64U - _k));
+        }
+
+        static inline uint64_t splitMix64(uint64_t &_x) noexcept {
+            uint64_t z = (_x += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31U);
+        }
+
+        /// generates next value of every lane
+        inline void nextLanes(uint64_t *_output) noexcept {
+            uint64_t *s0 = m_laneState[0];
+            uint64_t *s1 = m_laneState[1];
+            uint64_t *s2 = m_laneState[2];
+            uint64_t *s3 = m_laneState[3];
+            for (std::size_t l = 0; l < lanes; ++l) {
+                _output[l] = s0[l] + s3[l];
+                const uint64_t t = s1[l] << 17U;
+                s2[l] ^= s0[l];
+                s3[l] ^= s1[l];
+                s1[l] ^= s2[l];
+                s0[l] ^= s3[l];
+                s2[l] ^= t;
+                s3[l] = rotl(s3[l], 45);
+            }
+        }
+
+    public:
+        /**
+         * Constructs a generator
+         * @param _seed seed value, the same seed and stream produce the same sequence
+         * @param _stream stream ID, generators with different stream IDs produce independent sequences
+        */
+        explicit randomGenerator_t(uint64_t _seed, uint64_t _stream = 0) noexcept: m_state(), m_laneState() {
+            uint64_t x = _seed ^ (_stream * 0xd1b54a32d192ed03ULL);
+            for (auto &i:m_state) {
+                i = splitMix64(x);
+            }
+            for (auto &i:m_laneState) {
+                for (auto &j:i) {
+                    j = splitMix64(x);
+                }
+            }
+        }
+
+        static constexpr result_type min() noexcept {return 0;}
+        static constexpr result_type max() noexcept {return std::numeric_limits<result_type>::max();}
+
+        /// @returns next 64 bit random value
+        inline result_type operator()() noexcept {
+            const uint64_t ret = rotl(m_state[1] * 5, 7) * 9;
+            const uint64_t t = m_state[1] << 17U;
+            m_state[2] ^= m_state[0];
+            m_state[3] ^= m_state[1];
+            m_state[1] ^= m_state[2];
+            m_state[0] ^= m_state[3];
+            m_state[2] ^= t;
+            m_state[3] = rotl(m_state[3], 45);
+            return ret;
+        }
+
+        /// @returns uniformly distributed float value in [0, 1) range
+        inline float uniform() noexcept {
+            return static_cast<float>((*this)() >> 40U) * (1.0f / 16777216.0f);
+        }
+
+        /// @returns uniformly distributed integer value in [0, _range) range
+        inline uint32_t bounded(uint32_t _range) noexcept {
+            return static_cast<uint32_t>((((*this)() >> 32U) * _range) >> 32U);
+        }
+
+        /**
+         * Generates a sequence of 64 bit random values
+         * @param[out] _output buffer of at least _n elements
+         * @param _n amount of values to be generated
+        */
+        inline void fill(uint64_t *_output, std::size_t _n) noexcept {
+            std::size_t i = 0;
+            for (; i + lanes <= _n; i += lanes) {
+                nextLanes(_output + i);
+            }
+            if (i < _n) {
+                uint64_t rest[lanes];
+                nextLanes(rest);
+                for (std::size_t j = 0; i < _n; ++i, ++j) {
+                    _output[i] = rest[j];
+                }
+            }
+        }
+
+        /**
+         * Generates a sequence of 32 bit random values
+         * @param[out] _output buffer of at least _n elements
+         * @param _n amount of values to be generated
+        */
+        inline void fill(uint32_t *_output, std::size_t _n) noexcept {
+            uint64_t values[lanes];
+            for (std::size_t i = 0; i < _n; i += lanes * 2) {
+                nextLanes(values);
+                for (std::size_t l = 0; (l < lanes * 2) && (i + l < _n); ++l) {
+                    _output[i + l] = static_cast<uint32_t>(values[l / 2] >> ((l % 2) * 32U));
+                }
+            }
+        }
+
+        /**
+         * Generates a short sequence of 32 bit random values from one 64 bit value. Every output value is an integer
+         * hash (lowbias32) of its position mixed with the generated value, so a new sequence is as cheap as a few
+         * arithmetic operations per value and is not correlated with other sequences.
+         * @param[out] _output buffer of at least _n elements
+         * @param _n amount of values to be generated
+        */
+        inline void fillHashed(uint32_t *_output, std::size_t _n) noexcept {
+            const uint64_t key = (*this)();
+            const auto base = static_cast<uint32_t>(key);
+            const auto step = static_cast<uint32_t>(key >> 32U) | 1U; // odd step, positions are never mixed equally
+            for (std::size_t i = 0; i < _n; ++i) {
+                uint32_t x = base + step * static_cast<uint32_t>(i);
+                x ^= x >> 16U;
+                x *= 0x7feb352dU;
+                x ^= x >> 15U;
+                x *= 0x846ca68bU;
+                x ^= x >> 16U;
+                _output[i] = x;
+            }
+        }
+
+        /**
+         * Generates a sequence of uniformly distributed float values in [0, 1) range
+         * @param[out] _output buffer of at least _n elements
+         * @param _n amount of values to be generated
+        */
+        inline void uniform(float *_output, std::size_t _n) noexcept {
+            uint64_t values[lanes];
+            for (std::size_t i = 0; i < _n; i += lanes) {
+                nextLanes(values);
+                for (std::size_t l = 0; (l < lanes) && (i + l < _n); ++l) {
+                    _output[i + l] = static_cast<float>(values[l] >> 40U) * (1.0f / 16777216.0f);
+                }
+            }
+        }
+
+        /**
+         * Generates a sequence of uniformly distributed integer values in [0, _range) range
+         * @param _range upper bound (excluded) of generated values
+         * @param[out] _output buffer of at least _n elements
+         * @param _n amount of values to be generated
+        */
+        inline void bounded(uint32_t _range, uint32_t *_output, std::size_t _n) noexcept {
+            uint64_t values[lanes];
+            for (std::size_t i = 0; i < _n; i += lanes) {
+                nextLanes(values);
+                for (std::size_t l = 0; (l < lanes) && (i + l < _n); ++l) {
+                    _output[i + l] = static_cast<uint32_t>(((values[l] >> 32U) * _range) >> 32U);
+                }
+            }
+        }
+    };
+}
+
+#endif // WORD2VEC_RANDOMGENERATOR_H
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @brief trainChunks class - sentence aligned parts of the train data claimed by train threads
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <algorithm>
+
+#include "trainChunks.hpp"
+
+namespace w2v {
+    trainChunks_t::trainChunks_t(const corpus_t &_corpus, const delimiterScanner_t &_scanner,
+                                 std::size_t _chunks, std::size_t _iterations):
+            m_bounds(), m_iterations(_iterations), m_next(0) {
+        const std::size_t totalChunks = std::max<std::size_t>(1, _chunks);
+        m_bounds.push_back(0);
+        for (std::size_t f = 0; f < _corpus.files(); ++f) {
+            const char *data = _corpus.file(f).data();
+            const auto size = static_cast<std::size_t>(_corpus.file(f).size());
+            const auto offset = _corpus.offset(f);
+            const std::size_t chunks = std::max<std::size_t>(1, static_cast<std::size_t>(
+                    static_cast<double>(totalChunks) * size / _corpus.size() + 0.5));
+            const std::size_t chunkSize = std::max<std::size_t>(1, size / chunks);
+            std::size_t last = 0;
+            for (std::size_t i = 1; i < chunks; ++i) {
+                auto bound = std::max(last, size / chunks * i);
+                // the nearest end of sentence, very long sentences are split by a word delimiter
+                auto limit = std::min(size, bound + chunkSize);
+                auto pos = bound;
+                while ((pos < limit) && (_scanner.charClass(data[pos]) != delimiterScanner_t::END_OF_SENTENCE)) {
+                    ++pos;
+                }
+                if (pos == limit) {
+                    pos = static_cast<std::size_t>(_scanner.find(data + bound, data + size) - data);
+                }
+                pos = std::min(size, pos + 1);
+                if (pos > last) {
+                    m_bounds.push_back(offset + pos);
+                    last = pos;
+                }
+            }
+            if (size > last) {
+                m_bounds.push_back(offset + size);
+            }
+        }
+    }
+
+    trainChunks_t::trainChunks_t(const uint8_t *_data, std::size_t _size, std::size_t _chunks,
+                                 std::size_t _iterations): m_bounds(), m_iterations(_iterations), m_next(0) {
+        const std::size_t chunks = std::max<std::size_t>(1, _chunks);
+        m_bounds.push_back(0);
+        for (std::size_t i = 1; i < chunks; ++i) {
+            // every sentence of the cache is terminated by 0, 0 is never a part of a word index
+            auto pos = std::max(m_bounds.back() + 1, _size / chunks * i);
+            while ((pos < _size) && (_data[pos - 1] != 0)) {
+                ++pos;
+            }
+            if ((pos < _size) && (pos > m_bounds.back())) {
+                m_bounds.push_back(pos);
+            }
+        }
+        if (_size > m_bounds.back()) {
+            m_bounds.push_back(_size);
+        }
+    }
+}
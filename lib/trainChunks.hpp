@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief trainChunks class - sentence aligned parts of the train data claimed by train threads
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_TRAINCHUNKS_H
+#define WORD2VEC_TRAINCHUNKS_H
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "wordReader.hpp"
+#include "corpus.hpp"
+
+namespace w2v {
+    /**
+     * @brief trainChunks class - sentence aligned parts of the train data claimed by train threads
+     *
+     * Train data is divided into many more chunks than train threads, chunk bounds are aligned to sentence starts.
+     * Train threads claim chunks one by one with an atomic increment, so a thread which is done with its chunk takes
+     * the next one instead of idling while others process denser parts of the train data. Chunks of all iterations
+     * form one sequence, so chunks of the next iteration are claimed only after all chunks of the current iteration
+     * are taken and the learning rate decays evenly over the train data. The sequence number of a chunk is its
+     * position, a training resumed from a checkpoint starts from the saved position (see checkpoint_t).
+    */
+    class trainChunks_t final {
+    private:
+        std::vector<std::size_t> m_bounds; // i-th chunk is [m_bounds[i], m_bounds[i + 1])
+        const std::size_t m_iterations;
+        std::atomic<std::size_t> m_next;
+
+    public:
+        /**
+         * Divides a text train data into chunks, chunks of each file are its own, so a chunk never spans two files
+         * @param _corpus train data
+         * @param _scanner delimiter chars scanner, chunks start after an end of sentence char if there is one close to
+         * the chunk bound or after a word delimiter otherwise
+         * @param _chunks desired chunks number, they are shared by files in proportion to their sizes, each file has
+         * one chunk at least
+         * @param _iterations train iterations
+        */
+        trainChunks_t(const corpus_t &_corpus, const delimiterScanner_t &_scanner,
+                      std::size_t _chunks, std::size_t _iterations);
+
+        /**
+         * Divides a corpus cache into chunks
+         * @param _data corpus cache data, sentences are terminated by 0 (see corpusCache_t)
+         * @param _size corpus cache data size
+         * @param _chunks desired chunks number
+         * @param _iterations train iterations
+        */
+        trainChunks_t(const uint8_t *_data, std::size_t _size, std::size_t _chunks, std::size_t _iterations);
+
+        // copying prohibited
+        trainChunks_t(const trainChunks_t &) = delete;
+        void operator=(const trainChunks_t &) = delete;
+
+        /// @returns chunks number of one iteration
+        inline std::size_t size() const noexcept {return m_bounds.size() - 1;}
+
+        /// @returns start offset of the _index-th chunk of one iteration, bound(size()) is the end of the data
+        inline std::size_t bound(std::size_t _index) const noexcept {return m_bounds[_index];}
+
+        /// @returns chunks number of all iterations
+        inline std::size_t total() const noexcept {return size() * m_iterations;}
+
+        /**
+         * Claims the next chunk
+         * @param[out] _from chunk start offset
+         * @param[out] _to chunk end offset (excluded)
+         * @param[out] _position chunk sequence number
+         * @returns false if all chunks of all iterations are claimed
+        */
+        inline bool next(std::size_t &_from, std::size_t &_to, std::size_t &_position) noexcept {
+            auto i = m_next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= total()) {
+                return false;
+            }
+            _position = i;
+            i %= size();
+            _from = m_bounds[i];
+            _to = m_bounds[i + 1];
+            return true;
+        }
+
+        /// @returns sequence number of the next chunk to be claimed
+        inline std::size_t position() const noexcept {
+            return std::min(m_next.load(std::memory_order_relaxed), total());
+        }
+
+        /// Sets sequence number of the next chunk to be claimed, chunks before _position are skipped
+        inline void seek(std::size_t _position) noexcept {m_next.store(_position, std::memory_order_relaxed);}
+
+        /// Stops the training, no more chunks are claimed
+        inline void stop() noexcept {m_next.store(total(), std::memory_order_relaxed);}
+    };
+}
+
+#endif // WORD2VEC_TRAINCHUNKS_H
@@ -0,0 +1,293 @@
+/**
+ * @file
+ * @brief trainMatrix class - training matrix stored as 32-bit or 16-bit floats
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "trainMatrix.hpp"
+#include "vectorKernels.hpp"
+#include "randomGenerator.hpp"
+#include "numa.hpp"
+
+namespace w2v {
+    namespace {
+        /// rows of a block are generated by one random stream, streams of train threads are 1..255
+        const std::size_t randomBlockRows = 1024;
+        const uint64_t randomBlockStream = 256;
+
+        const std::size_t cacheLineSize = 64;
+        const std::size_t hugePageSize = 2 * 1024 * 1024;
+
+        inline std::size_t alignUp(std::size_t _value, std::size_t _alignment) noexcept {
+            return (_value + _alignment - 1) / _alignment * _alignment;
+        }
+    }
+
+    trainMatrix_t::trainMatrix_t(matrixPrecision_t _precision, std::size_t _rows, std::size_t _size,
+                                 bool _interleave, bool _hugePages):
+            m_precision(_precision), m_rows(_rows), m_size(_size),
+            m_elementSize((_precision == matrixPrecision_t::FP32) ? sizeof(float) : sizeof(uint16_t)),
+            m_stride(alignUp(_size * m_elementSize, cacheLineSize) / m_elementSize) {
+        allocate(_hugePages);
+        if (_interleave) {
+            numa_t::interleave(m_data, bytes());
+        }
+    }
+
+    trainMatrix_t::~trainMatrix_t() {
+        deallocate();
+    }
+
+    void trainMatrix_t::allocate(bool _hugePages) {
+        // memory is not touched here, pages are placed on the first write
+        const std::size_t size = std::max<std::size_t>(1, bytes());
+#if defined(__unix__) || defined(__APPLE__)
+        const int prot = PROT_READ | PROT_WRITE;
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (_hugePages && (size >= hugePageSize)) {
+#ifdef MAP_HUGETLB
+            // reserved huge pages, the call fails if there are not enough of them
+            m_memorySize = alignUp(size, hugePageSize);
+            m_memory = mmap(nullptr, m_memorySize, prot, flags | MAP_HUGETLB, -1, 0);
+            if (m_memory != MAP_FAILED) {
+                m_data = m_memory;
+                return;
+            }
+#endif
+            // transparent huge pages, the range is aligned to the huge page size
+            m_memorySize = alignUp(size, hugePageSize) + hugePageSize;
+            m_memory = mmap(nullptr, m_memorySize, prot, flags, -1, 0);
+            if (m_memory != MAP_FAILED) {
+                m_data = reinterpret_cast<void *>(alignUp(reinterpret_cast<uintptr_t>(m_memory), hugePageSize));
+#ifdef MADV_HUGEPAGE
+                madvise(m_data, alignUp(size, hugePageSize), MADV_HUGEPAGE);
+#endif
+                return;
+            }
+        }
+
+        // pages are aligned to cache lines
+        m_memorySize = size;
+        m_memory = mmap(nullptr, m_memorySize, prot, flags, -1, 0);
+        if (m_memory == MAP_FAILED) {
+            m_memory = nullptr;
+            throw std::runtime_error(std::string("trainMatrix: ") + std::strerror(errno));
+        }
+        m_data = m_memory;
+#else
+        (void) _hugePages;
+        m_memorySize = size + cacheLineSize;
+        m_memory = new uint8_t[m_memorySize];
+        m_data = reinterpret_cast<void *>(alignUp(reinterpret_cast<uintptr_t>(m_memory), cacheLineSize));
+#endif
+    }
+
+    void trainMatrix_t::deallocate() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+        if (m_memory != nullptr) {
+            munmap(m_memory, m_memorySize);
+        }
+#else
+        delete [] static_cast<uint8_t *>(m_memory);
+#endif
+        m_memory = nullptr;
+        m_memorySize = 0;
+        m_data = nullptr;
+    }
+
+    template <class func_t>
+    void trainMatrix_t::parallelRows(const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads,
+                                     func_t _func) const {
+        // thread ranges are aligned to the random blocks
+        const std::size_t blocks = (m_rows + randomBlockRows - 1) / randomBlockRows;
+        const std::size_t threadsNumber = std::max<std::size_t>(1, std::min(_threads, blocks));
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(threadsNumber);
+        try {
+            for (std::size_t t = 0; t < threadsNumber; ++t) {
+                auto from = std::min(m_rows, blocks * t / threadsNumber * randomBlockRows);
+                auto to = std::min(m_rows, blocks * (t + 1) / threadsNumber * randomBlockRows);
+                threads.emplace_back([&_func, &errors, t, from, to]() {
+                    try {
+                        _func(from, to);
+                    } catch (...) {
+                        errors[t] = std::current_exception();
+                    }
+                });
+                if (!_cpuAffinity.empty()) {
+                    numa_t::pin(threads.back(), _cpuAffinity[t % _cpuAffinity.size()]);
+                }
+            }
+        } catch (...) {
+            // started threads are finished before the error is passed to the caller
+            for (auto &i:threads) {
+                i.join();
+            }
+            throw;
+        }
+        for (auto &i:threads) {
+            i.join();
+        }
+        for (auto &i:errors) {
+            if (i) {
+                std::rethrow_exception(i);
+            }
+        }
+    }
+
+    void trainMatrix_t::zero(const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads) {
+        const std::size_t rowBytes = m_stride * m_elementSize;
+        auto data = static_cast<uint8_t *>(m_data);
+        parallelRows(_cpuAffinity, _threads, [data, rowBytes](std::size_t _from, std::size_t _to) {
+            std::memset(data + _from * rowBytes, 0, (_to - _from) * rowBytes);
+        });
+    }
+
+    void trainMatrix_t::randomize(uint64_t _seed, const std::vector<uint16_t> &_cpuAffinity,
+                                  std::size_t _threads) {
+        const auto &kernels = vectorKernels_t::instance(static_cast<uint16_t>(m_size));
+        parallelRows(_cpuAffinity, _threads, [this, _seed, &kernels](std::size_t _from, std::size_t _to) {
+            std::vector<float> row(m_size);
+            std::vector<float> block32;
+            std::vector<uint32_t> noise(m_size);
+            const std::size_t padding = (m_stride - m_size) * m_elementSize;
+            for (auto block = _from; block < _to; block += randomBlockRows) {
+                randomGenerator_t randomGenerator(_seed, randomBlockStream + block / randomBlockRows);
+                auto blockEnd = std::min(_to, block + randomBlockRows);
+                if (m_precision == matrixPrecision_t::FP32) {
+                    // values of the whole block are generated at once and copied to the padded rows
+                    block32.resize((blockEnd - block) * m_size);
+                    randomGenerator.uniform(block32.data(), block32.size());
+                    float *matrix = static_cast<float *>(m_data);
+                    for (auto r = block; r < blockEnd; ++r) {
+                        const float *values = &block32[(r - block) * m_size];
+                        float *output = &matrix[r * m_stride];
+                        for (std::size_t i = 0; i < m_size; ++i) {
+                            output[i] = (values[i] - 0.5f) * 0.01f;
+                        }
+                        std::memset(output + m_size, 0, padding);
+                    }
+                    continue;
+                }
+
+                // 16-bit rows are generated and converted one by one
+                for (auto r = block; r < blockEnd; ++r) {
+                    randomGenerator.uniform(row.data(), m_size);
+                    for (auto &i:row) {
+                        i = (i - 0.5f) * 0.01f;
+                    }
+                    randomGenerator.fill(noise.data(), m_size);
+                    uint16_t *output = static_cast<uint16_t *>(m_data) + r * m_stride;
+                    if (m_precision == matrixPrecision_t::BF16) {
+                        kernels.storeBF16(output, row.data(), noise.data(), m_size);
+                    } else {
+                        kernels.storeFP16(output, row.data(), noise.data(), m_size);
+                    }
+                    std::memset(output + m_size, 0, padding);
+                }
+            }
+        });
+    }
+
+    void trainMatrix_t::copyFrom(const std::vector<uint8_t> &_values, const std::vector<uint16_t> &_cpuAffinity,
+                                 std::size_t _threads) {
+        const std::size_t rowBytes = m_stride * m_elementSize;
+        const std::size_t valuesBytes = m_size * m_elementSize;
+        const std::size_t rows = std::min(m_rows, _values.size() / std::max<std::size_t>(1, valuesBytes));
+        auto data = static_cast<uint8_t *>(m_data);
+        auto values = _values.data();
+        parallelRows(_cpuAffinity, _threads, [data, values, rowBytes, valuesBytes, rows](std::size_t _from,
+                                                                                         std::size_t _to) {
+            for (auto r = _from; r < std::min(_to, rows); ++r) {
+                std::memcpy(data + r * rowBytes, values + r * valuesBytes, valuesBytes);
+                std::memset(data + r * rowBytes + valuesBytes, 0, rowBytes - valuesBytes);
+            }
+        });
+    }
+
+    void trainMatrix_t::copyTo(std::vector<uint8_t> &_output) const {
+        const std::size_t rowBytes = m_stride * m_elementSize;
+        const std::size_t valuesBytes = m_size * m_elementSize;
+        _output.resize(m_rows * valuesBytes);
+        auto data = static_cast<const uint8_t *>(m_data);
+        for (std::size_t r = 0; r < m_rows; ++r) {
+            std::memcpy(&_output[r * valuesBytes], data + r * rowBytes, valuesBytes);
+        }
+    }
+
+    void trainMatrix_t::pages(std::vector<std::size_t> &_pages) const noexcept {
+        numa_t::pages(m_data, bytes(), _pages);
+    }
+
+    void trainMatrix_t::discard(std::size_t _from, std::size_t _to) noexcept {
+#if (defined(__unix__) || defined(__APPLE__)) && defined(MADV_DONTNEED)
+        static const auto pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t rowBytes = m_stride * m_elementSize;
+        auto from = reinterpret_cast<uintptr_t>(m_data) + _from * rowBytes;
+        auto to = reinterpret_cast<uintptr_t>(m_data) + _to * rowBytes;
+        from = (from + pageSize - 1) / pageSize * pageSize;
+        to = to / pageSize * pageSize;
+        if (to > from) {
+            // reserved huge pages can not be partially released, they are freed with the whole matrix then
+            madvise(reinterpret_cast<void *>(from), to - from, MADV_DONTNEED);
+        }
+#else
+        (void) _from;
+        (void) _to;
+#endif
+    }
+
+    void trainMatrix_t::release(const std::function<void(std::size_t, const float *)> &_func,
+                                const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads) {
+        const auto &kernels = vectorKernels_t::instance(static_cast<uint16_t>(m_size));
+        std::exception_ptr error;
+        std::mutex errorLock;
+        parallelRows(_cpuAffinity, _threads, [&](std::size_t _from, std::size_t _to) {
+            try {
+                std::vector<float> row(m_size);
+                for (auto block = _from; block < _to; block += randomBlockRows) {
+                    auto blockEnd = std::min(_to, block + randomBlockRows);
+                    for (auto r = block; r < blockEnd; ++r) {
+                        const auto values = static_cast<const uint16_t *>(m_data) + r * m_stride;
+                        switch (m_precision) {
+                            case matrixPrecision_t::BF16:
+                                kernels.loadBF16(values, row.data(), m_size);
+                                _func(r, row.data());
+                                break;
+                            case matrixPrecision_t::FP16:
+                                kernels.loadFP16(values, row.data(), m_size);
+                                _func(r, row.data());
+                                break;
+                            default:
+                                _func(r, static_cast<const float *>(m_data) + r * m_stride);
+                                break;
+                        }
+                    }
+                    discard(block, blockEnd);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorLock);
+                error = std::current_exception();
+            }
+        });
+        deallocate();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
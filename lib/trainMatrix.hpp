@@ -0,0 +1,178 @@
+/**
+ * @file
+ * @brief trainMatrix class - training matrix stored as 32-bit or 16-bit floats
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_TRAINMATRIX_H
+#define WORD2VEC_TRAINMATRIX_H
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include "word2vec.hpp"
+
+namespace w2v {
+    /// bfloat16 matrix element
+    struct bf16_t final {
+        uint16_t bits; ///< the high half of fp32 bits
+    };
+
+    /// IEEE 754 half precision matrix element
+    struct fp16_t final {
+        uint16_t bits; ///< fp16 bits
+    };
+
+    /**
+     * @brief trainMatrix class - rows of word vectors or back propagation weights
+     *
+     * The matrix is stored in the format defined by matrixPrecision_t. 16-bit formats halve the memory footprint and
+     * the memory traffic of training, train threads convert rows to fp32 before the computations and back after
+     * them (see vectorKernels_t). Elements are accessed by data<value_t>(), where value_t is float, bf16_t or
+     * fp16_t depending on the matrix format.
+     * Rows are aligned to cache lines: a row starts stride() elements after the previous one, padding elements after
+     * row values are never used. Matrices of a huge page size or larger are allocated on huge pages if the system
+     * provides them (reserved or transparent huge pages), so random rows access does not miss TLB on every row.
+     * Memory is allocated without touching it and initialized by several threads, each thread writes its own part of
+     * rows. With the default first-touch policy pages are placed on NUMA nodes of initializing threads, so when they
+     * are pinned to the same CPUs as train threads, the matrix is spread over the nodes used by training.
+    */
+    class trainMatrix_t final {
+    private:
+        const matrixPrecision_t m_precision;
+        const std::size_t m_rows;
+        const std::size_t m_size;
+        const std::size_t m_elementSize;
+        const std::size_t m_stride;
+        void *m_memory = nullptr; // allocated memory, mmap() is used if it is available
+        std::size_t m_memorySize = 0; // allocated memory size
+        void *m_data = nullptr; // the first row, aligned
+
+        /// @returns size of the matrix memory in bytes
+        inline std::size_t bytes() const noexcept {return m_rows * m_stride * m_elementSize;}
+
+        /**
+         * Allocates aligned matrix memory without touching it
+         * @param _hugePages try to allocate huge pages
+        */
+        void allocate(bool _hugePages);
+        /// frees matrix memory
+        void deallocate() noexcept;
+        /// returns memory pages of rows [_from, _to) to the system, pages shared with other rows are kept
+        void discard(std::size_t _from, std::size_t _to) noexcept;
+
+        /**
+         * Calls _func(from, to) for row ranges in parallel
+         * @param _cpuAffinity CPU of i-th thread is _cpuAffinity[i % _cpuAffinity.size()], empty - threads are not
+         * pinned
+         * @param _threads threads number
+         * @throws std::system_error In case of a thread can not be started, or an exception thrown by _func
+        */
+        template <class func_t>
+        void parallelRows(const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads, func_t _func) const;
+
+    public:
+        /**
+         * Constructs a matrix, its values are not initialized, see zero() and randomize()
+         * @param _precision storage format
+         * @param _rows number of rows
+         * @param _size row size
+         * @param _interleave place memory pages interleaved over all NUMA nodes instead of the first-touch policy
+         * @param _hugePages allocate the matrix on huge pages if the system provides them
+        */
+        trainMatrix_t(matrixPrecision_t _precision, std::size_t _rows, std::size_t _size, bool _interleave,
+                      bool _hugePages);
+        ~trainMatrix_t();
+
+        // copying prohibited
+        trainMatrix_t(const trainMatrix_t &) = delete;
+        void operator=(const trainMatrix_t &) = delete;
+
+        /// @returns storage format
+        inline matrixPrecision_t precision() const noexcept {return m_precision;}
+        /// @returns number of rows
+        inline std::size_t rows() const noexcept {return m_rows;}
+        /// @returns row size
+        inline std::size_t size() const noexcept {return m_size;}
+        /// @returns distance between rows in elements, row size padded to a cache line
+        inline std::size_t stride() const noexcept {return m_stride;}
+
+        /// @returns pointer to the matrix elements, value_t must match the storage format
+        template <class value_t>
+        inline value_t *data() noexcept;
+
+        /**
+         * Fills the matrix with zero values in parallel
+         * @param _cpuAffinity CPUs of initializing threads, see trainSettings_t::cpuAffinity
+         * @param _threads initializing threads number
+         * @throws std::system_error In case of initializing threads can not be started
+        */
+        void zero(const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads);
+
+        /**
+         * Fills the matrix with small random values, uniformly distributed in [-0.005, 0.005) range, in parallel.
+         * Each block of rows has its own random stream of the seed, so values do not depend on threads number.
+         * @param _seed random generators seed
+         * @param _cpuAffinity CPUs of initializing threads, see trainSettings_t::cpuAffinity
+         * @param _threads initializing threads number
+         * @throws std::system_error In case of initializing threads can not be started
+         * @throws std::bad_alloc In case of memory allocation failed
+        */
+        void randomize(uint64_t _seed, const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads);
+
+        /**
+         * Fills the first rows of the matrix with packed rows in the storage format in parallel, the rest of rows is
+         * not changed
+         * @param _values packed rows in the storage format, not more than rows * size elements, see copyTo()
+         * @param _cpuAffinity CPUs of initializing threads, see trainSettings_t::cpuAffinity
+         * @param _threads initializing threads number
+         * @throws std::system_error In case of initializing threads can not be started
+        */
+        void copyFrom(const std::vector<uint8_t> &_values, const std::vector<uint16_t> &_cpuAffinity,
+                      std::size_t _threads);
+
+        /**
+         * Copies the matrix to packed rows in the storage format, the padding is dropped. The matrix may be updated
+         * by train threads while it is copied.
+         * @param[out] _output rows * size elements in the storage format
+        */
+        void copyTo(std::vector<uint8_t> &_output) const;
+
+        /**
+         * Counts memory pages of the matrix by NUMA nodes
+         * @param[in,out] _pages pages counters, see numa_t::pages()
+        */
+        void pages(std::vector<std::size_t> &_pages) const noexcept;
+
+        /**
+         * Passes matrix rows to _func(row, values) in parallel and frees the matrix. 16-bit values are converted to
+         * fp32, the padding is dropped. Memory pages of passed rows are returned to the system while the rest of
+         * rows is processed, so the matrix memory is moved to the row consumer instead of being doubled.
+         * The matrix is empty after the call.
+         * @param _func called once for each row, may be called by several threads at the same time
+         * @param _cpuAffinity CPUs of releasing threads, see trainSettings_t::cpuAffinity
+         * @param _threads releasing threads number
+        */
+        void release(const std::function<void(std::size_t, const float *)> &_func,
+                     const std::vector<uint16_t> &_cpuAffinity, std::size_t _threads);
+    };
+
+    template <>
+    inline float *trainMatrix_t::data<float>() noexcept {
+        return (m_precision == matrixPrecision_t::FP32) ? static_cast<float *>(m_data) : nullptr;
+    }
+
+    template <>
+    inline bf16_t *trainMatrix_t::data<bf16_t>() noexcept {
+        return (m_precision == matrixPrecision_t::BF16) ? static_cast<bf16_t *>(m_data) : nullptr;
+    }
+
+    template <>
+    inline fp16_t *trainMatrix_t::data<fp16_t>() noexcept {
+        return (m_precision == matrixPrecision_t::FP16) ? static_cast<fp16_t *>(m_data) : nullptr;
+    }
+}
+
+#endif // WORD2VEC_TRAINMATRIX_H
@@ -7,15 +7,40 @@
 */
 
 #include <stdexcept>
+#include <algorithm>
 
 #include "trainThread.hpp"
 
 namespace w2v {
-    trainThread_t::trainThread_t(uint8_t _id, const sharedData_t &_sharedData) :
-            m_sharedData(_sharedData), m_randomDevice(), m_randomGenerator(m_randomDevice()),
-            m_rndWindowShift(0, static_cast<short>((m_sharedData.trainSettings->window - 1))),
-            m_downSampling(), m_nsDistribution(), m_hiddenLayerVals(), m_hiddenLayerErrors(),
-            m_wordReader(), m_thread() {
+    template <class value_t>
+    trainThread_t::worker_t trainThread_t::specializedWorker(uint16_t _size) noexcept {
+        // the same vector sizes are specialized by vectorKernels_t
+        switch (_size) {
+            case 50: return &trainThread_t::worker<50, value_t>;
+            case 100: return &trainThread_t::worker<100, value_t>;
+            case 128: return &trainThread_t::worker<128, value_t>;
+            case 200: return &trainThread_t::worker<200, value_t>;
+            case 256: return &trainThread_t::worker<256, value_t>;
+            case 300: return &trainThread_t::worker<300, value_t>;
+            case 500: return &trainThread_t::worker<500, value_t>;
+            default: return &trainThread_t::worker<0, value_t>;
+        }
+    }
+
+    trainThread_t::worker_t trainThread_t::specializedWorker(uint16_t _size, matrixPrecision_t _precision) noexcept {
+        switch (_precision) {
+            case matrixPrecision_t::BF16: return specializedWorker<bf16_t>(_size);
+            case matrixPrecision_t::FP16: return specializedWorker<fp16_t>(_size);
+            default: return specializedWorker<float>(_size);
+        }
+    }
+
+    trainThread_t::trainThread_t(uint8_t _id, const sharedData_t &_sharedData, worker_t _worker) :
+            m_sharedData(_sharedData), m_id(_id), m_worker(_worker),
+            m_kernels(vectorKernels_t::instance(m_sharedData.trainSettings->size)),
+            m_randomGenerator(m_sharedData.seed, _id + 1U), m_windowShifts(), m_sentence(),
+            m_negatives(), m_hiddenLayerVals(), m_hiddenLayerErrors(), m_batchData(),
+            m_inputRow(), m_outputRow(), m_noise(), m_wordReader(), m_thread() {
 
         if (!m_sharedData.trainSettings) {
             throw std::runtime_error("train settings are not initialized");
@@ -24,273 +49,527 @@ namespace w2v {
             throw std::runtime_error("vocabulary object is not initialized");
         }
 
-        if (m_sharedData.trainSettings->sample > 0.0f) {
-            m_downSampling.reset(new downSampling_t(m_sharedData.trainSettings->sample,
-                                                    m_sharedData.vocabulary->trainWords()));
-        }
-
-        if (m_sharedData.trainSettings->negative > 0) {
-            std::vector<std::size_t> frequencies;
-            m_sharedData.vocabulary->frequencies(frequencies);
-            m_nsDistribution.reset(new nsDistribution_t(frequencies));
+        if (!m_sharedData.trainSettings->withHS && (m_sharedData.trainSettings->negative > 0)) {
+            if (!m_sharedData.nsDistribution) {
+                throw std::runtime_error("negative sampling distribution object is not initialized");
+            }
+            // the buffer is filled on the first request
+            m_negatives.resize(1024);
+            m_negativesPos = m_negatives.size();
+            // negative examples of the next prefetchDistance targets
+            m_prefetchNegatives = std::min(m_negatives.size() / 2,
+                                           static_cast<std::size_t>(m_sharedData.trainSettings->prefetchDistance)
+                                           * m_sharedData.trainSettings->negative);
         }
 
         if (m_sharedData.trainSettings->withHS && !m_sharedData.huffmanTree) {
             throw std::runtime_error("Huffman tree object is not initialized");
         }
 
+        if (!m_sharedData.trainSettings->cpuAffinity.empty()) {
+            const auto &cpuAffinity = m_sharedData.trainSettings->cpuAffinity;
+            m_cpu = cpuAffinity[_id % cpuAffinity.size()];
+        }
+
         m_hiddenLayerErrors.reset(new std::vector<float>(m_sharedData.trainSettings->size));
+        if (m_sharedData.trainSettings->precision != matrixPrecision_t::FP32) {
+            m_inputRow.resize(m_sharedData.trainSettings->size);
+            m_outputRow.resize(m_sharedData.trainSettings->size);
+            m_noise.resize(m_sharedData.trainSettings->size);
+        }
         if (!m_sharedData.trainSettings->withSG) {
             m_hiddenLayerVals.reset(new std::vector<float>(m_sharedData.trainSettings->size));
         }
+        if (m_sharedData.trainSettings->withBatchedSG) {
+            std::size_t contexts = m_sharedData.trainSettings->window * 2U;
+            std::size_t outputs = m_sharedData.trainSettings->negative + 1U;
+            m_batchData.reset(new batchData_t());
+            m_batchData->inputIndexes.resize(contexts);
+            m_batchData->outputIndexes.resize(outputs);
+            m_batchData->inputs.resize(contexts * m_sharedData.trainSettings->size);
+            m_batchData->outputs.resize(outputs * m_sharedData.trainSettings->size);
+            m_batchData->gradients.resize(contexts * outputs);
+            m_batchData->gradientsT.resize(contexts * outputs);
+            m_batchData->inputsDelta.resize(contexts * m_sharedData.trainSettings->size);
+            m_batchData->outputsDelta.resize(outputs * m_sharedData.trainSettings->size);
+        }
 
-        if (!m_sharedData.fileMapper) {
-            throw std::runtime_error("file mapper object is not initialized");
+        if (!m_sharedData.processedWords || (m_sharedData.processedWords->size() <= _id)
+            || !m_sharedData.trainedChunks || (m_sharedData.trainedChunks->size() <= _id)
+            || !m_sharedData.finishedThreads) {
+            throw std::runtime_error("processed words counters are not initialized");
+        }
+        if (!m_sharedData.trainChunks) {
+            throw std::runtime_error("train data chunks are not initialized");
         }
-        auto shift = m_sharedData.fileMapper->size() / m_sharedData.trainSettings->threads;
-        auto startFrom = shift * _id;
-        auto stopAt = (_id == m_sharedData.trainSettings->threads - 1)
-                      ? (m_sharedData.fileMapper->size() - 1) : (shift * (_id + 1));
-        m_wordReader.reset(new wordReader_t<fileMapper_t>(*m_sharedData.fileMapper,
+        if (!m_sharedData.corpusCache && !m_sharedData.corpus) {
+            throw std::runtime_error("corpus object is not initialized");
+        }
+    }
+
+    inline bool trainThread_t::nextChunk() noexcept {
+        std::size_t from = 0;
+        std::size_t to = 0;
+        std::size_t position = 0;
+        auto &trainedChunk = (*m_sharedData.trainedChunks)[m_id].value;
+        if (!m_sharedData.trainChunks->next(from, to, position)) {
+            trainedChunk.store(noChunk, std::memory_order_relaxed);
+            return false;
+        }
+        // a checkpoint resumes the training from the first chunk which is not finished
+        // merged private rows of the previous chunk are visible to a checkpoint which reads this position
+        trainedChunk.store(position, std::memory_order_release);
+        if (m_sharedData.corpusCache) {
+            m_cachePos = m_sharedData.corpusCache->data() + from;
+            m_cacheTo = m_sharedData.corpusCache->data() + to;
+        } else {
+            // a chunk is a part of one file
+            const auto file = m_sharedData.corpus->fileAt(from);
+            const auto offset = m_sharedData.corpus->offset(file);
+            m_wordReader.reset(new wordReader_t<mapper_t>(m_sharedData.corpus->file(file),
                                                           m_sharedData.trainSettings->wordDelimiterChars,
                                                           m_sharedData.trainSettings->endOfSentenceChars,
-                                                          startFrom, stopAt));
+                                                          range_t{static_cast<off_t>(from - offset),
+                                                                  static_cast<off_t>(to - offset)}));
+        }
+        return true;
     }
 
-    void trainThread_t::worker(std::vector<float> &_trainMatrix) noexcept {
-        for (auto i = m_sharedData.trainSettings->iterations; i > 0; --i) {
+    inline bool trainThread_t::nextSentence(std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                            std::size_t &_processedWords) noexcept {
+        const char *word = nullptr;
+        std::size_t length = 0;
+        while (true) {
+            if (!m_wordReader->nextWord(word, length)) {
+                return false; // EOF or end of requested region
+            }
+            if (length == 0) {
+                return true; // end of sentence
+            }
+
+            auto wordData = m_sharedData.vocabulary->data(word, length);
+            if (wordData == nullptr) {
+                continue; // no such word
+            }
+
+            _processedWords++;
+
+            if (downSampled(wordData->index)) {
+                continue; // skip this word
+            }
+            _sentence.push_back(wordData);
+        }
+    }
+
+    inline bool trainThread_t::nextCachedSentence(std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                                  std::size_t &_processedWords) noexcept {
+        if (m_cachePos >= m_cacheTo) {
+            return false; // end of requested region
+        }
+        // every sentence in the cache is terminated by 0, words out of vocabulary are already dropped
+        // the cache holds word indexes, so discarded words do not touch the vocabulary at all
+        for (auto value = corpusCache_t::next(m_cachePos); value != 0; value = corpusCache_t::next(m_cachePos)) {
+            auto index = static_cast<std::size_t>(value - 1);
+            _processedWords++;
+
+            if (downSampled(index)) {
+                continue; // skip this word
+            }
+            _sentence.push_back(m_sharedData.vocabulary->data(index));
+        }
+        return m_cachePos < m_cacheTo;
+    }
+
+    template <class value_t>
+    void trainThread_t::initHotRows(value_t *_matrix, hotRows_t &_hot, std::size_t _from, std::size_t _count,
+                                    std::size_t _size) noexcept {
+        _hot.from = _from;
+        _hot.count = 0; // rows are copied from the shared matrix
+        _hot.rows.resize(_count * _size);
+        for (std::size_t i = 0; i < _count; ++i) {
+            copyRow(_matrix, _hot, _from + i, _size, &_hot.rows[i * _size]);
+        }
+        _hot.base = _hot.rows;
+        _hot.count = _count;
+    }
+
+    template <class value_t>
+    void trainThread_t::mergeHotRows(value_t *_matrix, hotRows_t &_hot, std::size_t _size) noexcept {
+        for (std::size_t i = 0; i < _hot.count; ++i) {
+            float *privateRow = &_hot.rows[i * _size];
+            float *baseRow = &_hot.base[i * _size];
+            float *row = loadRow(_matrix, _hot.from + i, _size, m_inputRow.data());
+            for (std::size_t k = 0; k < _size; ++k) {
+                row[k] += privateRow[k] - baseRow[k];
+            }
+            storeRow(_matrix, _hot.from + i, _size, row);
+
+            // the stored values are read back, 16-bit rows are rounded while stored
+            const float *stored = loadRow(_matrix, _hot.from + i, _size, privateRow);
+            if (stored != privateRow) {
+                std::memcpy(privateRow, stored, _size * sizeof(float));
+            }
+            std::memcpy(baseRow, privateRow, _size * sizeof(float));
+        }
+    }
+
+    template <uint16_t size_, class value_t>
+    void trainThread_t::worker(trainMatrix_t &_trainMatrix) noexcept {
+        value_t *trainMatrix = _trainMatrix.data<value_t>();
+        value_t *bpWeights = m_sharedData.bpWeights->data<value_t>();
+        // both matrices have the same format and row size, so the same rows stride
+        m_stride = _trainMatrix.stride();
+        std::size_t threadProcessedWords = 0;
+        std::size_t prvThreadProcessedWords = 0;
+        auto wordsPerAllThreads = m_sharedData.trainSettings->iterations
+                                  * m_sharedData.vocabulary->trainWords();
+        auto wordsPerAlpha = wordsPerAllThreads / 10000;
+        auto &counter = (*m_sharedData.processedWords)[m_id].value;
+        m_alpha = alpha(m_sharedData);
+
+        const auto &settings = *m_sharedData.trainSettings;
+        const std::size_t size = (size_ > 0) ? size_ : settings.size;
+        if (settings.hotRows > 0) {
+            // the most frequent words have the lowest indexes, Huffman tree nodes close to the root the highest ones
+            const std::size_t rows = m_sharedData.bpWeights->rows();
+            if (settings.withHS) {
+                const std::size_t nodes = (rows > 0) ? rows - 1 : 0;
+                const std::size_t count = std::min(settings.hotRows, nodes);
+                initHotRows(bpWeights, m_hotOutput, nodes - count, count, size);
+            } else {
+                initHotRows(bpWeights, m_hotOutput, 0, std::min(settings.hotRows, rows), size);
+            }
+            if (settings.hotInputRows) {
+                initHotRows(trainMatrix, m_hotInput, 0, std::min(settings.hotRows, rows), size);
+            }
+        }
+        std::size_t prvMergeProcessedWords = 0;
+        // chunks of all iterations are claimed one by one until they are over
+        while (nextChunk()) {
             bool exitFlag = false;
-            std::size_t threadProcessedWords = 0;
-            std::size_t prvThreadProcessedWords = 0;
-            m_wordReader->reset();
-            auto wordsPerAllThreads = m_sharedData.trainSettings->iterations
-                              * m_sharedData.vocabulary->trainWords();
-            auto wordsPerAlpha = wordsPerAllThreads / 10000;
             while (!exitFlag) {
                 // calc alpha
                 if (threadProcessedWords - prvThreadProcessedWords > wordsPerAlpha) { // next 0.01% processed
-                    *m_sharedData.processedWords += threadProcessedWords - prvThreadProcessedWords;
+                    // the thread writes its own cache line only, other counters are just read
+                    counter.store(threadProcessedWords, std::memory_order_relaxed);
                     prvThreadProcessedWords = threadProcessedWords;
 
-                    float ratio =
-                            static_cast<float>(*(m_sharedData.processedWords)) / wordsPerAllThreads;
-
-                    auto curAlpha = m_sharedData.trainSettings->alpha * (1 - ratio);
-                    if (curAlpha < m_sharedData.trainSettings->alpha * 0.0001f) {
-                        curAlpha = m_sharedData.trainSettings->alpha * 0.0001f;
-                    }
-                    (*m_sharedData.alpha) = curAlpha;
-
-                    if (m_sharedData.progressCallback != nullptr) {
-                        m_sharedData.progressCallback(curAlpha, ratio * 100.0f);
-                    }
+                    float ratio = static_cast<float>(processedWords(m_sharedData)) / wordsPerAllThreads;
+                    m_alpha = alpha(*m_sharedData.trainSettings, ratio);
                 }
 
                 // read sentence
-                std::vector<const vocabulary_t::wordData_t *> sentence;
-                while (true) {
-                    std::string word;
-                    if (!m_wordReader->nextWord(word)) {
-                        exitFlag = true; // EOF or end of requested region
-                        break;
-                    }
-                    if (word.empty()) {
-                        break; // end of sentence
-                    }
-
-                    auto wordData = m_sharedData.vocabulary->data(word);
-                    if (wordData == nullptr) {
-                        continue; // no such word
-                    }
-
-                    threadProcessedWords++;
-
-                    if (m_sharedData.trainSettings->sample > 0.0f) { // down-sampling...
-                        if ((*m_downSampling)(wordData->frequency, m_randomGenerator)) {
-                            continue; // skip this word
-                        }
-                    }
-                    sentence.push_back(wordData);
+                m_sentence.clear();
+                if (!m_sharedData.corpusCache) {
+                    exitFlag = !nextSentence(m_sentence, threadProcessedWords);
+                } else {
+                    exitFlag = !nextCachedSentence(m_sentence, threadProcessedWords);
                 }
 
-                if (m_sharedData.trainSettings->withSG) {
-                    skipGram(sentence, _trainMatrix);
+                if (m_sharedData.trainSettings->withBatchedSG) {
+                    skipGramBatched<size_>(m_sentence, trainMatrix, bpWeights);
+                } else if (m_sharedData.trainSettings->withSG) {
+                    skipGram<size_>(m_sentence, trainMatrix, bpWeights);
                 } else {
-                    cbow(sentence, _trainMatrix);
+                    cbow<size_>(m_sentence, trainMatrix, bpWeights);
+                }
+
+                if ((settings.hotRows > 0)
+                    && (threadProcessedWords - prvMergeProcessedWords >= settings.hotRowsSyncWords)) {
+                    mergeHotRows(bpWeights, m_hotOutput, size);
+                    mergeHotRows(trainMatrix, m_hotInput, size);
+                    prvMergeProcessedWords = threadProcessedWords;
                 }
             }
+
+            // private rows are merged before the next chunk is claimed, so a checkpoint resumed from the first
+            // unfinished chunk does not lose updates of the finished ones
+            mergeHotRows(bpWeights, m_hotOutput, size);
+            mergeHotRows(trainMatrix, m_hotInput, size);
+            prvMergeProcessedWords = threadProcessedWords;
         }
+        counter.store(threadProcessedWords, std::memory_order_relaxed);
+        m_sharedData.finishedThreads->fetch_add(1, std::memory_order_release);
     }
 
+    template <uint16_t size_, class value_t>
     inline void trainThread_t::cbow(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
-                                    std::vector<float> &_trainMatrix) noexcept {
+                                    value_t *_trainMatrix, value_t *_bpWeights) noexcept {
+        const std::size_t size = (size_ > 0) ? size_ : m_sharedData.trainSettings->size;
+        const short window = m_sharedData.trainSettings->window;
+        const bool withHS = m_sharedData.trainSettings->withHS;
+        float *hiddenLayerVals = m_hiddenLayerVals->data();
+        float *hiddenLayerErrors = m_hiddenLayerErrors->data();
+        const std::size_t prefetchDistance = m_sharedData.trainSettings->prefetchDistance;
+        windowShifts(_sentence.size());
+        if (prefetchDistance > 0) {
+            prefetchWords(_sentence, 0, prefetchDistance, _trainMatrix, _bpWeights, size);
+        }
         for (std::size_t i = 0; i < _sentence.size(); ++i) {
+            if (prefetchDistance > 0) {
+                prefetchWords(_sentence, i + prefetchDistance, i + prefetchDistance + 1, _trainMatrix, _bpWeights,
+                              size);
+            }
+
             // hidden layers initialized with 0 values
-            std::memset(m_hiddenLayerVals->data(), 0, m_hiddenLayerVals->size() * sizeof(float));
-            std::memset(m_hiddenLayerErrors->data(), 0, m_hiddenLayerErrors->size() * sizeof(float));
+            std::memset(hiddenLayerVals, 0, size * sizeof(float));
+            std::memset(hiddenLayerErrors, 0, size * sizeof(float));
 
-            auto rndShift = m_rndWindowShift(m_randomGenerator);
+            auto rndShift = static_cast<short>(m_windowShifts[i]);
             std::size_t cw = 0;
-            for (auto j = rndShift; j < m_sharedData.trainSettings->window * 2 + 1 - rndShift; ++j) {
-                if (j == m_sharedData.trainSettings->window) {
+            for (auto j = rndShift; j < window * 2 + 1 - rndShift; ++j) {
+                if (j == window) {
                     continue;
                 }
 
-                auto posRndWindow = i - m_sharedData.trainSettings->window + j;
+                auto posRndWindow = i - window + j;
                 if (posRndWindow >= _sentence.size()) {
                     continue;
                 }
-                for (std::size_t k = 0; k < m_sharedData.trainSettings->size; ++k) {
-                    (*m_hiddenLayerVals)[k] += _trainMatrix[k + _sentence[posRndWindow]->index
-                                                           * m_sharedData.trainSettings->size];
+                const float *row = loadRow(_trainMatrix, m_hotInput, _sentence[posRndWindow]->index, size,
+                                           m_inputRow.data());
+                for (std::size_t k = 0; k < size; ++k) {
+                    hiddenLayerVals[k] += row[k];
                 }
                 cw++;
             }
             if (cw == 0) {
                 continue;
             }
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; j++) {
-                (*m_hiddenLayerVals)[j] /= cw;
+            for (std::size_t j = 0; j < size; j++) {
+                hiddenLayerVals[j] /= cw;
             }
 
-            if (m_sharedData.trainSettings->withHS) {
-                hierarchicalSoftmax(_sentence[i]->index, *m_hiddenLayerErrors, *m_hiddenLayerVals, 0);
+            if (withHS) {
+                hierarchicalSoftmax<size_>(_sentence[i]->index, hiddenLayerErrors, hiddenLayerVals, _bpWeights);
             } else {
-                negativeSampling(_sentence[i]->index, *m_hiddenLayerErrors, *m_hiddenLayerVals, 0);
+                negativeSampling<size_>(_sentence[i]->index, hiddenLayerErrors, hiddenLayerVals, _bpWeights);
             }
 
             // hidden -> in
-            for (auto j = rndShift; j < m_sharedData.trainSettings->window * 2 + 1 - rndShift; ++j) {
-                if (j == m_sharedData.trainSettings->window) {
+            for (auto j = rndShift; j < window * 2 + 1 - rndShift; ++j) {
+                if (j == window) {
                     continue;
                 }
 
-                auto posRndWindow = i - m_sharedData.trainSettings->window + j;
+                auto posRndWindow = i - window + j;
                 if (posRndWindow >= _sentence.size()) {
                     continue;
                 }
-                for (std::size_t k = 0; k < m_sharedData.trainSettings->size; ++k) {
-                    _trainMatrix[k + _sentence[posRndWindow]->index * m_sharedData.trainSettings->size]
-                            += (*m_hiddenLayerErrors)[k];
-                }
+                addRow(_trainMatrix, m_hotInput, _sentence[posRndWindow]->index, size, hiddenLayerErrors);
             }
         }
     }
 
+    template <uint16_t size_, class value_t>
     inline void trainThread_t::skipGram(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
-                                        std::vector<float> &_trainMatrix) noexcept {
+                                        value_t *_trainMatrix, value_t *_bpWeights) noexcept {
+        const std::size_t size = (size_ > 0) ? size_ : m_sharedData.trainSettings->size;
+        const short window = m_sharedData.trainSettings->window;
+        const bool withHS = m_sharedData.trainSettings->withHS;
+        float *hiddenLayerErrors = m_hiddenLayerErrors->data();
+        const std::size_t prefetchDistance = m_sharedData.trainSettings->prefetchDistance;
+        windowShifts(_sentence.size());
+        if (prefetchDistance > 0) {
+            prefetchWords(_sentence, 0, prefetchDistance, _trainMatrix, _bpWeights, size);
+        }
         for (std::size_t i = 0; i < _sentence.size(); ++i) {
-            auto rndShift = m_rndWindowShift(m_randomGenerator);
-            for (auto j = rndShift; j < m_sharedData.trainSettings->window * 2 + 1 - rndShift; ++j) {
-                if (j == m_sharedData.trainSettings->window) {
+            if (prefetchDistance > 0) {
+                prefetchWords(_sentence, i + prefetchDistance, i + prefetchDistance + 1, _trainMatrix, _bpWeights,
+                              size);
+            }
+
+            auto rndShift = static_cast<short>(m_windowShifts[i]);
+            for (auto j = rndShift; j < window * 2 + 1 - rndShift; ++j) {
+                if (j == window) {
                     continue;
                 }
 
-                auto posRndWindow = i - m_sharedData.trainSettings->window + j;
+                auto posRndWindow = i - window + j;
                 if (posRndWindow >= _sentence.size()) {
                     continue;
                 }
-                // shift to the selected word vector in the matrix
-                auto shift = _sentence[posRndWindow]->index * m_sharedData.trainSettings->size;
+                // the selected word vector in the matrix
+                auto index = _sentence[posRndWindow]->index;
+                float *row = loadRow(_trainMatrix, m_hotInput, index, size, m_inputRow.data());
 
                 // hidden layer initialized with 0 values
-                std::memset(m_hiddenLayerErrors->data(), 0, m_hiddenLayerErrors->size() * sizeof(float));
+                std::memset(hiddenLayerErrors, 0, size * sizeof(float));
 
-                if (m_sharedData.trainSettings->withHS) {
-                    hierarchicalSoftmax(_sentence[i]->index, (*m_hiddenLayerErrors), _trainMatrix, shift);
+                if (withHS) {
+                    hierarchicalSoftmax<size_>(_sentence[i]->index, hiddenLayerErrors, row, _bpWeights);
                 } else {
-                    negativeSampling(_sentence[i]->index, (*m_hiddenLayerErrors), _trainMatrix, shift);
+                    negativeSampling<size_>(_sentence[i]->index, hiddenLayerErrors, row, _bpWeights);
                 }
 
-                for (std::size_t k = 0; k < m_sharedData.trainSettings->size; ++k) {
-                    _trainMatrix[k + shift] += (*m_hiddenLayerErrors)[k];
+                for (std::size_t k = 0; k < size; ++k) {
+                    row[k] += hiddenLayerErrors[k];
                 }
+                storeRow(_trainMatrix, m_hotInput, index, size, row);
             }
         }
     }
 
-    inline void trainThread_t::hierarchicalSoftmax(std::size_t _index,
-                                                   std::vector<float> &_hiddenLayer,
-                                                   std::vector<float> &_trainLayer,
-                                                   std::size_t _trainLayerShift) noexcept {
-        auto huffmanData = m_sharedData.huffmanTree->huffmanData(_index);
-        for (std::size_t i = 0; i < huffmanData->huffmanCode.size(); ++i) {
-            auto l2 = huffmanData->huffmanPoint[i] * m_sharedData.trainSettings->size;
-            // Propagate hidden -> output
-            float f = 0.0f;
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; ++j) {
-                f += _trainLayer[j + _trainLayerShift] * (*m_sharedData.bpWeights)[j + l2];
+    template <uint16_t size_, class value_t>
+    inline void trainThread_t::skipGramBatched(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                               value_t *_trainMatrix, value_t *_bpWeights) noexcept {
+        const std::size_t size = (size_ > 0) ? size_ : m_sharedData.trainSettings->size;
+        const short window = m_sharedData.trainSettings->window;
+        const float expValueMax = m_sharedData.trainSettings->expValueMax;
+        const std::size_t expTableScale = m_sharedData.expTable->size() / m_sharedData.trainSettings->expValueMax / 2;
+        const std::size_t outputs = m_sharedData.trainSettings->negative + 1U;
+        auto &batch = *m_batchData;
+        const std::size_t prefetchDistance = m_sharedData.trainSettings->prefetchDistance;
+        windowShifts(_sentence.size());
+        if (prefetchDistance > 0) {
+            prefetchWords(_sentence, 0, prefetchDistance, _trainMatrix, _bpWeights, size);
+        }
+        for (std::size_t i = 0; i < _sentence.size(); ++i) {
+            if (prefetchDistance > 0) {
+                prefetchWords(_sentence, i + prefetchDistance, i + prefetchDistance + 1, _trainMatrix, _bpWeights,
+                              size);
             }
-            if (f < -m_sharedData.trainSettings->expValueMax) {
+
+            // gather context words vectors
+            auto rndShift = static_cast<short>(m_windowShifts[i]);
+            std::size_t contexts = 0;
+            for (auto j = rndShift; j < window * 2 + 1 - rndShift; ++j) {
+                if (j == window) {
+                    continue;
+                }
+
+                auto posRndWindow = i - window + j;
+                if (posRndWindow >= _sentence.size()) {
+                    continue;
+                }
+                batch.inputIndexes[contexts] = _sentence[posRndWindow]->index;
+                copyRow(_trainMatrix, m_hotInput, _sentence[posRndWindow]->index, size,
+                        &batch.inputs[contexts * size]);
+                contexts++;
+            }
+            if (contexts == 0) {
+                continue;
+            }
+
+            // gather target word and negative words shared by all context words
+            batch.outputIndexes[0] = _sentence[i]->index;
+            for (std::size_t o = 1; o < outputs; ++o) {
+                batch.outputIndexes[o] = nextNegative();
+                prefetchNegative(_bpWeights, size);
+            }
+            for (std::size_t o = 0; o < outputs; ++o) {
+                copyRow(_bpWeights, m_hotOutput, batch.outputIndexes[o], size, &batch.outputs[o * size]);
+            }
+
+            // Propagate hidden -> output, all context words at once
+            m_kernels.gemmNT(batch.inputs.data(), batch.outputs.data(), batch.gradients.data(),
+                             contexts, outputs, size);
+            const float alpha = m_alpha;
+            for (std::size_t c = 0; c < contexts; ++c) {
+                for (std::size_t o = 0; o < outputs; ++o) {
+                    float gradientXalpha = 0.0f;
+                    if ((o == 0) || (batch.outputIndexes[o] != batch.outputIndexes[0])) {
+                        float f = batch.gradients[c * outputs + o];
+                        if (f < -expValueMax) {
+                            f = 0.0f;
+                        } else if (f > expValueMax) {
+                            f = 1.0f;
+                        } else {
+                            f = (*m_sharedData.expTable)[static_cast<std::size_t>((f + expValueMax) * expTableScale)];
+                        }
+                        gradientXalpha = (static_cast<float>(o == 0) - f) * alpha;
+                    }
+                    batch.gradients[c * outputs + o] = gradientXalpha;
+                    batch.gradientsT[o * contexts + c] = gradientXalpha;
+                }
+            }
+
+            // Propagate errors output -> hidden and learn weights hidden -> output
+            m_kernels.gemmNN(batch.gradients.data(), batch.outputs.data(), batch.inputsDelta.data(),
+                             contexts, outputs, size);
+            m_kernels.gemmNN(batch.gradientsT.data(), batch.inputs.data(), batch.outputsDelta.data(),
+                             outputs, contexts, size);
+
+            // scatter updates, repeated words accumulate all of their deltas
+            for (std::size_t c = 0; c < contexts; ++c) {
+                addRow(_trainMatrix, m_hotInput, batch.inputIndexes[c], size, &batch.inputsDelta[c * size]);
+            }
+            for (std::size_t o = 0; o < outputs; ++o) {
+                if ((o > 0) && (batch.outputIndexes[o] == batch.outputIndexes[0])) {
+                    continue;
+                }
+                addRow(_bpWeights, m_hotOutput, batch.outputIndexes[o], size, &batch.outputsDelta[o * size]);
+            }
+        }
+    }
+
+    template <uint16_t size_, class value_t>
+    inline void trainThread_t::hierarchicalSoftmax(std::size_t _index, float *_hiddenLayer,
+                                                   const float *_trainLayer, value_t *_bpWeights) noexcept {
+        const std::size_t size = (size_ > 0) ? size_ : m_sharedData.trainSettings->size;
+        const float expValueMax = m_sharedData.trainSettings->expValueMax;
+        const std::size_t expTableScale = m_sharedData.expTable->size() / m_sharedData.trainSettings->expValueMax / 2;
+        const auto huffmanData = m_sharedData.huffmanTree->huffmanData(_index);
+        for (std::size_t i = 0; i < huffmanData.length; ++i) {
+            auto point = huffmanData.points[i];
+            float *bpWeights = loadRow(_bpWeights, m_hotOutput, point, size, m_outputRow.data());
+            // Propagate hidden -> output
+            float f = m_kernels.dot(_trainLayer, bpWeights, size);
+            if (f < -expValueMax) {
 //            f = 0.0f;
                 continue; // original approach
-            } else if (f > m_sharedData.trainSettings->expValueMax) {
+            } else if (f > expValueMax) {
 //            f = 1.0f;
                 continue; // original approach
             } else {
-                f = (*m_sharedData.expTable)[static_cast<std::size_t>((f + m_sharedData.trainSettings->expValueMax)
-                                                                      * (m_sharedData.expTable->size()
-                                                                         / m_sharedData.trainSettings->expValueMax /
-                                                                         2))];
+                f = (*m_sharedData.expTable)[static_cast<std::size_t>((f + expValueMax) * expTableScale)];
             }
 
-            auto gradientXalpha = (1.0f - static_cast<float>(huffmanData->huffmanCode[i]) - f) * (*m_sharedData.alpha);
-            // Propagate errors output -> hidden
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; ++j) {
-                _hiddenLayer[j] += gradientXalpha * (*m_sharedData.bpWeights)[j + l2];
-            }
-            // Learn weights hidden -> output
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; ++j) {
-                (*m_sharedData.bpWeights)[j + l2] += gradientXalpha * _trainLayer[j + _trainLayerShift];
-            }
+            auto gradientXalpha = (1.0f - static_cast<float>(huffmanData.code(i)) - f) * m_alpha;
+            // Propagate errors output -> hidden and learn weights hidden -> output
+            m_kernels.update(_hiddenLayer, bpWeights, _trainLayer, gradientXalpha, size);
+            storeRow(_bpWeights, m_hotOutput, point, size, bpWeights);
         }
     }
 
-    inline void trainThread_t::negativeSampling(std::size_t _index,
-                                                std::vector<float> &_hiddenLayer,
-                                                std::vector<float> &_trainLayer,
-                                                std::size_t _trainLayerShift) noexcept {
-        for (std::size_t i = 0; i < static_cast<std::size_t>(m_sharedData.trainSettings->negative) + 1; ++i) {
+    template <uint16_t size_, class value_t>
+    inline void trainThread_t::negativeSampling(std::size_t _index, float *_hiddenLayer,
+                                                const float *_trainLayer, value_t *_bpWeights) noexcept {
+        const std::size_t size = (size_ > 0) ? size_ : m_sharedData.trainSettings->size;
+        const float expValueMax = m_sharedData.trainSettings->expValueMax;
+        const std::size_t expTableScale = m_sharedData.expTable->size() / m_sharedData.trainSettings->expValueMax / 2;
+        const std::size_t negative = m_sharedData.trainSettings->negative;
+        for (std::size_t i = 0; i < negative + 1; ++i) {
             std::size_t target = 0;
             bool label = false;
             if (i == 0) {
                 target = _index;
                 label = true;
             } else {
-                target = (*m_nsDistribution)(m_randomGenerator);
+                target = nextNegative();
+                prefetchNegative(_bpWeights, size);
                 if (target == _index) {
                     continue;
                 }
             }
 
-            auto l2 = target * m_sharedData.trainSettings->size;
+            float *bpWeights = loadRow(_bpWeights, m_hotOutput, target, size, m_outputRow.data());
             // Propagate hidden -> output
-            float f = 0.0f;
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; ++j) {
-                f += _trainLayer[j + _trainLayerShift] * (*m_sharedData.bpWeights)[j + l2];
-            }
-            if (f < -m_sharedData.trainSettings->expValueMax) {
+            float f = m_kernels.dot(_trainLayer, bpWeights, size);
+            if (f < -expValueMax) {
                 f = 0.0f;  // original approach
 //            continue;
-            } else if (f > m_sharedData.trainSettings->expValueMax) {
+            } else if (f > expValueMax) {
                 f = 1.0f;  // original approach
 //            continue;
             } else {
-                f = (*m_sharedData.expTable)[static_cast<std::size_t>((f + m_sharedData.trainSettings->expValueMax)
-                                                                      * (m_sharedData.expTable->size()
-                                                                         / m_sharedData.trainSettings->expValueMax /
-                                                                         2))];
+                f = (*m_sharedData.expTable)[static_cast<std::size_t>((f + expValueMax) * expTableScale)];
             }
 
-            auto gradientXalpha = (static_cast<float>(label) - f) * (*m_sharedData.alpha);
-            // Propagate errors output -> hidden
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; ++j) {
-                _hiddenLayer[j] += gradientXalpha * (*m_sharedData.bpWeights)[j + l2];
-            }
-            // Learn weights hidden -> output
-            for (std::size_t j = 0; j < m_sharedData.trainSettings->size; ++j) {
-                (*m_sharedData.bpWeights)[j + l2] += gradientXalpha * _trainLayer[j + _trainLayerShift];
-            }
+            auto gradientXalpha = (static_cast<float>(label) - f) * m_alpha;
+            // Propagate errors output -> hidden and learn weights hidden -> output
+            m_kernels.update(_hiddenLayer, bpWeights, _trainLayer, gradientXalpha, size);
+            storeRow(_bpWeights, m_hotOutput, target, size, bpWeights);
         }
     }
 }
@@ -9,8 +9,8 @@
 #ifndef WORD2VEC_TRAINTHREAD_H
 #define WORD2VEC_TRAINTHREAD_H
 
+#include <cstring>
 #include <memory>
-#include <random>
 #include <thread>
 #include <atomic>
 #include <functional>
@@ -21,62 +21,197 @@
 #include "vocabulary.hpp"
 #include "huffmanTree.hpp"
 #include "nsDistribution.hpp"
+#include "corpusCache.hpp"
+#include "trainChunks.hpp"
 #include "downSampling.hpp"
+#include "vectorKernels.hpp"
+#include "randomGenerator.hpp"
+#include "trainMatrix.hpp"
+#include "numa.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+// prefetch helpers have no side effects for the compiler, so their calls may be removed unless they are inlined
+#define W2V_PREFETCH_INLINE __attribute__((always_inline)) inline
+#else
+#define W2V_PREFETCH_INLINE inline
+#endif
 
 namespace w2v {
     /**
      * @brief trainThread class - train thread and its local data
      *
-     *  trainThread class trains a word2vec model from the specified part of train data set file.
+     *  trainThread class trains a word2vec model from chunks of train data set file claimed one by one by all
+     *  train threads (see trainChunks_t).
      *  Here are two supported training model algorithms - CBOW and Skip-Gram and two approximation algorithms to
      *  speedup training - Hierarchical Softmax (HS) and Negative Sampling (NS).
      *  It is possible to choose any of the following algorithms combination - CBOW/HS or CBOW/NS or Skip-Gram/HS or
      *  Skip-Gram/NS.
+     *  Batched Skip-Gram/NS (pWord2Vec approach) draws one set of negative examples per window and trains all
+     *  context words against the target and negative words as small dense matrix products.
+     *  Training bodies are templates of the word vector size, so the most common sizes have fully unrolled loops
+     *  with compile-time trip counts while any other size uses the generic (size_ = 0) specialization. They are
+     *  also templates of the matrices element type, rows of 16-bit matrices are converted to fp32 scratch rows
+     *  before the computations and written back with stochastic rounding.
     */
     class trainThread_t final {
     public:
+        /**
+         * @brief counter of one train thread, counters of different threads never share a cache line
+        */
+        struct wordsCounter_t final {
+            std::atomic<std::size_t> value; ///< counter value
+            char padding[64 - sizeof(std::atomic<std::size_t>)]; ///< the rest of the cache line
+
+            wordsCounter_t() noexcept: value(0), padding() {}
+        };
+
         /**
          * @brief sharedData structure holds all common data used by train threads
         */
         struct sharedData_t final {
             std::shared_ptr<trainSettings_t> trainSettings; ///< trainSettings structure
             std::shared_ptr<vocabulary_t> vocabulary; ///< words data
-            std::shared_ptr<fileMapper_t> fileMapper; ///< train data file access object
-            std::shared_ptr<std::vector<float>> bpWeights; ///< back propagation weights
+            std::shared_ptr<corpus_t> corpus; ///< train data files
+            std::shared_ptr<corpusCache_t> corpusCache; ///< pre-tokenized train data, used instead of corpus
+            std::shared_ptr<trainChunks_t> trainChunks; ///< chunks of corpus or corpusCache data
+            std::shared_ptr<trainMatrix_t> bpWeights; ///< back propagation weights
             std::shared_ptr<std::vector<float>> expTable; ///< exp(x) / (exp(x) + 1) values lookup table
             std::shared_ptr<huffmanTree_t> huffmanTree; ///< Huffman tree used by hierarchical softmax
-            std::shared_ptr<std::atomic<std::size_t>> processedWords; ///< total words processed by train threads
-            std::shared_ptr<std::atomic<float>> alpha; ///< current learning rate
-            std::function<void(float, float)> progressCallback = nullptr; ///< callback with alpha and training percent
+            std::shared_ptr<nsDistribution_t> nsDistribution; ///< distribution of negative examples
+            std::shared_ptr<downSampling_t> downSampling; ///< frequent words down-sampling, nullptr - disabled
+            std::shared_ptr<std::vector<wordsCounter_t>> processedWords; ///< words processed by each train thread
+            /// position of the chunk trained by each train thread, see trainChunks_t, noChunk - no chunk is trained
+            std::shared_ptr<std::vector<wordsCounter_t>> trainedChunks;
+            std::size_t resumedWords = 0; ///< words processed before the training was resumed from a checkpoint
+            std::shared_ptr<std::atomic<std::size_t>> finishedThreads; ///< number of train threads which are done
+            uint64_t seed = 0; ///< random generators seed, each thread uses its own stream of the seed
         };
 
+        /// trainedChunks value of a thread which does not train a chunk
+        static const std::size_t noChunk = static_cast<std::size_t>(-1);
+
+        /// train thread worker type, specialized by word vector size and matrices storage format
+        using worker_t = void (trainThread_t::*)(trainMatrix_t &);
+
     private:
+        /// local data of batched Skip-Gram, all matrices are row-major
+        struct batchData_t final {
+            std::vector<std::size_t> inputIndexes; ///< context words indexes
+            std::vector<std::size_t> outputIndexes; ///< target word index followed by negative words indexes
+            std::vector<float> inputs; ///< context words vectors (contexts x size)
+            std::vector<float> outputs; ///< target and negative words weights (outputs x size)
+            std::vector<float> gradients; ///< scores, then gradients multiplied by alpha (contexts x outputs)
+            std::vector<float> gradientsT; ///< transposed gradients (outputs x contexts)
+            std::vector<float> inputsDelta; ///< context words vectors updates (contexts x size)
+            std::vector<float> outputsDelta; ///< target and negative words weights updates (outputs x size)
+        };
+
+        /**
+         * @brief thread private fp32 copies of a range of matrix rows
+         *
+         * The most used rows are updated by every train thread all the time, so their cache lines move between CPUs
+         * on each update. A thread updates its private copies instead and adds the accumulated changes to the
+         * shared matrix from time to time.
+        */
+        struct hotRows_t final {
+            std::size_t from = 0; ///< first row of the range
+            std::size_t count = 0; ///< rows number, 0 - no private rows
+            std::vector<float> rows; ///< private rows updated by the thread
+            std::vector<float> base; ///< shared rows values read by the last merge
+        };
+
         sharedData_t m_sharedData;
+        const uint8_t m_id;
+        const worker_t m_worker;
+        const vectorKernels_t m_kernels;
 
-        std::random_device m_randomDevice;
-        std::mt19937_64 m_randomGenerator;
-        std::uniform_int_distribution<short> m_rndWindowShift;
-        std::unique_ptr<downSampling_t> m_downSampling;
-        std::unique_ptr<nsDistribution_t> m_nsDistribution;
+        randomGenerator_t m_randomGenerator;
+        std::vector<uint32_t> m_windowShifts; ///< random window shifts of the current sentence words
+        std::vector<const vocabulary_t::wordData_t *> m_sentence; ///< current sentence, reused by all sentences
+        std::vector<std::size_t> m_negatives; ///< negative examples drawn ahead of use
+        std::size_t m_negativesPos = 0; ///< next negative example position in m_negatives
+        std::size_t m_prefetchNegatives = 0; ///< negative examples prefetched ahead of use, 0 - no prefetching
         std::unique_ptr<std::vector<float>> m_hiddenLayerVals;
         std::unique_ptr<std::vector<float>> m_hiddenLayerErrors;
-        std::unique_ptr<wordReader_t<fileMapper_t>> m_wordReader;
+        std::unique_ptr<batchData_t> m_batchData;
+        std::vector<float> m_inputRow; ///< fp32 scratch row of the input matrix, used by 16-bit matrices
+        std::vector<float> m_outputRow; ///< fp32 scratch row of the back propagation weights, used by 16-bit matrices
+        std::vector<uint32_t> m_noise; ///< random bits of the stochastic rounding of one row
+        std::unique_ptr<wordReader_t<mapper_t>> m_wordReader;
+        const uint8_t *m_cacheTo = nullptr; ///< end of the current chunk of the corpus cache
+        const uint8_t *m_cachePos = nullptr; ///< current position in the corpus cache
+        int m_cpu = -1; ///< CPU the thread is pinned to, -1 - not pinned
+        float m_alpha = 0.0f; ///< learning rate, updated between sentences
+        std::size_t m_stride = 0; ///< distance between matrix rows in elements, see trainMatrix_t::stride()
+        hotRows_t m_hotInput; ///< private rows of the input matrix
+        hotRows_t m_hotOutput; ///< private rows of the back propagation weights
         std::unique_ptr<std::thread> m_thread;
 
     public:
+        /**
+         * Selects train thread worker specialized for the vector size and the matrices storage format
+         * @param _size word vector size
+         * @param _precision matrices storage format
+         * @returns worker with compile-time vector size if _size is one of the common sizes or generic worker
+        */
+        static worker_t specializedWorker(uint16_t _size, matrixPrecision_t _precision) noexcept;
+
+        /// @returns total words processed by all train threads
+        static std::size_t processedWords(const sharedData_t &_sharedData) noexcept {
+            std::size_t ret = _sharedData.resumedWords;
+            for (auto const &i:*_sharedData.processedWords) {
+                ret += i.value.load(std::memory_order_relaxed);
+            }
+            return ret;
+        }
+
+        /**
+         * Calculates the learning rate
+         * @param _trainSettings train settings
+         * @param _ratio processed part of all train words of all iterations
+         * @returns the starting learning rate linearly decayed to 0.01% of its value
+        */
+        static float alpha(const trainSettings_t &_trainSettings, float _ratio) noexcept {
+            auto ret = _trainSettings.alpha * (1 - _ratio);
+            if (ret < _trainSettings.alpha * 0.0001f) {
+                ret = _trainSettings.alpha * 0.0001f;
+            }
+            return ret;
+        }
+
+        /**
+         * Calculates the learning rate of the words processed so far, words processed before the training was
+         * resumed are counted too, so a resumed training continues with the learning rate it was stopped with
+         * @param _sharedData train threads shared data
+         * @returns the current learning rate
+        */
+        static float alpha(const sharedData_t &_sharedData) noexcept {
+            const auto wordsPerAllThreads = _sharedData.trainSettings->iterations
+                                            * _sharedData.vocabulary->trainWords();
+            if (wordsPerAllThreads == 0) {
+                return _sharedData.trainSettings->alpha;
+            }
+            return alpha(*_sharedData.trainSettings,
+                         static_cast<float>(processedWords(_sharedData)) / wordsPerAllThreads);
+        }
+
         /**
          * Constructs train thread local data
          * @param _id thread ID, starting from 0
          * @param _sharedData sharedData object instantiated outside of the thread
+         * @param _worker worker specialized for the vector size and storage format, see specializedWorker()
         */
-        trainThread_t(uint8_t _id, const sharedData_t &_sharedData);
+        trainThread_t(uint8_t _id, const sharedData_t &_sharedData, worker_t _worker);
 
         /**
          * Launchs the thread
          * @param[out] _trainMatrix - train model matrix
         */
-        void launch(std::vector<float> &_trainMatrix) noexcept {
-            m_thread.reset(new std::thread(&trainThread_t::worker, this, std::ref(_trainMatrix)));
+        void launch(trainMatrix_t &_trainMatrix) noexcept {
+            m_thread.reset(new std::thread(m_worker, this, std::ref(_trainMatrix)));
+            if (m_cpu >= 0) {
+                numa_t::pin(*m_thread, static_cast<uint16_t>(m_cpu));
+            }
         }
         /// Joins to the thread
         void join() noexcept {
@@ -84,18 +219,206 @@ namespace w2v {
         }
 
     private:
-        void worker(std::vector<float> &_trainMatrix) noexcept;
+        /// @returns next negative example, buffer of negative examples is refilled in bulk when it is exhausted
+        inline std::size_t nextNegative() noexcept {
+            if (m_negativesPos == m_negatives.size()) {
+                m_sharedData.nsDistribution->draw(m_negatives.size(), m_negatives.data(), m_randomGenerator);
+                m_negativesPos = 0;
+            }
+            return m_negatives[m_negativesPos++];
+        }
+
+        /// prefetches all cache lines of a matrix row, the row is going to be updated
+        template <class value_t>
+        W2V_PREFETCH_INLINE void prefetchRow(const value_t *_matrix, std::size_t _row, std::size_t _size) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            // rows are aligned to cache lines
+            const std::size_t cacheLine = 64;
+            const auto row = reinterpret_cast<const char *>(_matrix + _row * m_stride);
+            const std::size_t bytes = _size * sizeof(value_t);
+            for (std::size_t offset = 0; offset < bytes; offset += cacheLine) {
+                __builtin_prefetch(row + offset, 1, 3);
+            }
+#else
+            (void) _matrix;
+            (void) _row;
+            (void) _size;
+#endif
+        }
+
+        /**
+         * Prefetches rows which are going to be trained: output rows of sentence words [_from, _to) (Huffman tree
+         * nodes of their codes with hierarchical softmax) and input rows of the words which enter the window then
+        */
+        template <class value_t>
+        W2V_PREFETCH_INLINE void prefetchWords(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                  std::size_t _from, std::size_t _to,
+                                  const value_t *_trainMatrix, const value_t *_bpWeights, std::size_t _size) noexcept {
+            const std::size_t window = m_sharedData.trainSettings->window;
+            for (auto i = _from; i < _to && i < _sentence.size(); ++i) {
+                if (m_sharedData.trainSettings->withHS) {
+                    const auto huffmanData = m_sharedData.huffmanTree->huffmanData(_sentence[i]->index);
+                    for (std::size_t j = 0; j < huffmanData.length; ++j) {
+                        prefetchRow(_bpWeights, huffmanData.points[j], _size);
+                    }
+                } else {
+                    prefetchRow(_bpWeights, _sentence[i]->index, _size);
+                }
+            }
+            for (auto i = _from + window; i < _to + window && i < _sentence.size(); ++i) {
+                prefetchRow(_trainMatrix, _sentence[i]->index, _size);
+            }
+        }
+
+        /// prefetches the row of the negative example drawn m_prefetchNegatives draws later
+        template <class value_t>
+        W2V_PREFETCH_INLINE void prefetchNegative(const value_t *_bpWeights, std::size_t _size) noexcept {
+            auto pos = m_negativesPos + m_prefetchNegatives;
+            if ((m_prefetchNegatives > 0) && (pos < m_negatives.size())) {
+                prefetchRow(_bpWeights, m_negatives[pos], _size);
+            }
+        }
+
+        /// generates random window shifts for all words of a sentence at once
+        inline void windowShifts(std::size_t _sentenceSize) noexcept {
+            if (m_windowShifts.size() < _sentenceSize) {
+                m_windowShifts.resize(_sentenceSize);
+            }
+            m_randomGenerator.bounded(m_sharedData.trainSettings->window, m_windowShifts.data(), _sentenceSize);
+        }
+
+        /// @returns true if a word has to be skipped by down-sampling
+        inline bool downSampled(std::size_t _index) noexcept {
+            return m_sharedData.downSampling && (*m_sharedData.downSampling)(_index, m_randomGenerator);
+        }
+
+        /// claims the next chunk of the train data, @returns false if all chunks are processed
+        inline bool nextChunk() noexcept;
+
+        /**
+         * Reads the next sentence of the current chunk of the train data
+         * @param[out] _sentence sentence words, down-sampling applied
+         * @param[in,out] _processedWords processed words counter
+         * @returns false if the end of the chunk is reached
+        */
+        inline bool nextSentence(std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                 std::size_t &_processedWords) noexcept;
+        inline bool nextCachedSentence(std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                       std::size_t &_processedWords) noexcept;
+
+        /// @returns pointer to a fp32 matrix row, rows are updated in place
+        inline float *loadRow(float *_matrix, std::size_t _row, std::size_t, float *) noexcept {
+            return _matrix + _row * m_stride;
+        }
+        /// @returns pointer to a bf16 matrix row converted to fp32 in _buffer
+        inline float *loadRow(bf16_t *_matrix, std::size_t _row, std::size_t _size, float *_buffer) noexcept {
+            m_kernels.loadBF16(&_matrix[_row * m_stride].bits, _buffer, _size);
+            return _buffer;
+        }
+        /// @returns pointer to a fp16 matrix row converted to fp32 in _buffer
+        inline float *loadRow(fp16_t *_matrix, std::size_t _row, std::size_t _size, float *_buffer) noexcept {
+            m_kernels.loadFP16(&_matrix[_row * m_stride].bits, _buffer, _size);
+            return _buffer;
+        }
+
+        /// @returns pointer to the private copy of a hot row or to the matrix row loaded by loadRow()
+        template <class value_t>
+        inline float *loadRow(value_t *_matrix, hotRows_t &_hot, std::size_t _row, std::size_t _size,
+                              float *_buffer) noexcept {
+            const auto i = _row - _hot.from;
+            if (i < _hot.count) {
+                return &_hot.rows[i * _size];
+            }
+            return loadRow(_matrix, _row, _size, _buffer);
+        }
+
+        /// writes back a row returned by loadRow(), fp32 rows are already updated in place
+        inline void storeRow(float *, std::size_t, std::size_t, const float *) noexcept {}
+        inline void storeRow(bf16_t *_matrix, std::size_t _row, std::size_t _size, const float *_values) noexcept {
+            m_kernels.storeBF16(&_matrix[_row * m_stride].bits, _values, noise(_size), _size);
+        }
+        inline void storeRow(fp16_t *_matrix, std::size_t _row, std::size_t _size, const float *_values) noexcept {
+            m_kernels.storeFP16(&_matrix[_row * m_stride].bits, _values, noise(_size), _size);
+        }
+        /// writes back a row returned by loadRow(), private copies of hot rows are updated in place
+        template <class value_t>
+        inline void storeRow(value_t *_matrix, hotRows_t &_hot, std::size_t _row, std::size_t _size,
+                             const float *_values) noexcept {
+            if (_row - _hot.from >= _hot.count) {
+                storeRow(_matrix, _row, _size, _values);
+            }
+        }
+
+        /**
+         * @returns random bits of the stochastic rounding for one row. Bits are generated for every store, so the
+         * rounding of a value is independent of other values and of its previous stores.
+        */
+        inline const uint32_t *noise(std::size_t _size) noexcept {
+            m_randomGenerator.fillHashed(m_noise.data(), _size);
+            return m_noise.data();
+        }
+
+        /// copies a matrix row to _output as fp32 values
+        template <class value_t>
+        inline void copyRow(value_t *_matrix, hotRows_t &_hot, std::size_t _row, std::size_t _size,
+                            float *_output) noexcept {
+            const float *row = loadRow(_matrix, _hot, _row, _size, _output);
+            if (row != _output) {
+                std::memcpy(_output, row, _size * sizeof(float));
+            }
+        }
+
+        /// adds _delta to a matrix row
+        template <class value_t>
+        inline void addRow(value_t *_matrix, hotRows_t &_hot, std::size_t _row, std::size_t _size,
+                           const float *_delta) noexcept {
+            float *row = loadRow(_matrix, _hot, _row, _size, m_inputRow.data());
+            for (std::size_t k = 0; k < _size; ++k) {
+                row[k] += _delta[k];
+            }
+            storeRow(_matrix, _hot, _row, _size, row);
+        }
+
+        /**
+         * Makes private copies of matrix rows
+         * @param _matrix shared matrix
+         * @param[out] _hot private rows
+         * @param _from first row
+         * @param _count rows number
+         * @param _size row size
+        */
+        template <class value_t>
+        void initHotRows(value_t *_matrix, hotRows_t &_hot, std::size_t _from, std::size_t _count,
+                         std::size_t _size) noexcept;
+
+        /**
+         * Adds changes of private rows since the last merge to the shared matrix and refreshes private rows with the
+         * shared values, which include updates of other threads
+        */
+        template <class value_t>
+        void mergeHotRows(value_t *_matrix, hotRows_t &_hot, std::size_t _size) noexcept;
+
+        template <class value_t>
+        static worker_t specializedWorker(uint16_t _size) noexcept;
+
+        template <uint16_t size_, class value_t>
+        void worker(trainMatrix_t &_trainMatrix) noexcept;
 
+        template <uint16_t size_, class value_t>
         inline void cbow(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
-                         std::vector<float> &_trainMatrix) noexcept;
+                         value_t *_trainMatrix, value_t *_bpWeights) noexcept;
+        template <uint16_t size_, class value_t>
         inline void skipGram(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
-                             std::vector<float> &_trainMatrix) noexcept;
-        inline void  hierarchicalSoftmax(std::size_t _index,
-                                         std::vector<float> &_hiddenLayer,
-                                         std::vector<float> &_trainLayer, std::size_t _trainLayerShift) noexcept;
-        inline void negativeSampling(std::size_t _index,
-                                     std::vector<float> &_hiddenLayer,
-                                     std::vector<float> &_trainLayer, std::size_t _trainLayerShift) noexcept;
+                             value_t *_trainMatrix, value_t *_bpWeights) noexcept;
+        template <uint16_t size_, class value_t>
+        inline void skipGramBatched(const std::vector<const vocabulary_t::wordData_t *> &_sentence,
+                                    value_t *_trainMatrix, value_t *_bpWeights) noexcept;
+        template <uint16_t size_, class value_t>
+        inline void hierarchicalSoftmax(std::size_t _index, float *_hiddenLayer,
+                                        const float *_trainLayer, value_t *_bpWeights) noexcept;
+        template <uint16_t size_, class value_t>
+        inline void negativeSampling(std::size_t _index, float *_hiddenLayer,
+                                     const float *_trainLayer, value_t *_bpWeights) noexcept;
     };
 
 }
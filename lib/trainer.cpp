@@ -7,32 +7,90 @@
 */
 
 #include <stdexcept>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include "trainer.hpp"
+#include "numa.hpp"
 
 namespace w2v {
     trainer_t::trainer_t(const std::shared_ptr<trainSettings_t> &_trainSettings,
                          const std::shared_ptr<vocabulary_t> &_vocabulary,
-                         const std::shared_ptr<fileMapper_t> &_fileMapper,
-                         std::function<void(float, float)> _progressCallback): m_threads() {
+                         const std::shared_ptr<corpus_t> &_corpus,
+                         std::function<void(float, float)> _progressCallback,
+                         std::function<void(std::size_t, std::size_t, std::size_t)> _numaStatsCallback,
+                         const std::shared_ptr<checkpoint_t> &_checkpoint,
+                         const std::shared_ptr<checkpoint_t> &_baseModel):
+        m_trainSettings(_trainSettings), m_bpWeights(), m_numaStatsCallback(_numaStatsCallback), m_progressCallback(),
+        m_sharedData(), m_threads(), m_checkpoint(_checkpoint), m_resumed(_checkpoint != nullptr),
+        m_baseModel(_baseModel), m_checkpointWriter(), m_checkpointWritten(true), m_checkpointError() {
         trainThread_t::sharedData_t sharedData;
 
         if (!_trainSettings) {
             throw std::runtime_error("train settings are not initialized");
         }
         sharedData.trainSettings = _trainSettings;
+        if (_trainSettings->withBatchedSG && (!_trainSettings->withSG || _trainSettings->withHS
+                                              || (_trainSettings->negative == 0))) {
+            throw std::runtime_error("batched training requires Skip-Gram model and negative sampling");
+        }
 
         if (!_vocabulary) {
             throw std::runtime_error("vocabulary object is not initialized");
         }
         sharedData.vocabulary = _vocabulary;
 
-        if (!_fileMapper) {
-            throw std::runtime_error("file mapper object is not initialized");
+        if (!_corpus) {
+            throw std::runtime_error("corpus object is not initialized");
+        }
+        sharedData.corpus = _corpus;
+        if (!_trainSettings->corpusCacheFile.empty()) {
+            // text corpus is parsed once, all iterations are trained from the word indexes stream
+            sharedData.corpusCache.reset(new corpusCache_t(_trainSettings->corpusCacheFile, *_corpus,
+                                                           *_vocabulary, *_trainSettings));
+        } else if (_corpus->compressedFiles() > 0) {
+            // compressed files are decoded once to a temporary cache instead of decoding them every iteration
+            sharedData.corpusCache.reset(new corpusCache_t(*_corpus, *_vocabulary, *_trainSettings));
         }
-        sharedData.fileMapper = _fileMapper;
 
-        sharedData.bpWeights.reset(new std::vector<float>(_trainSettings->size * _vocabulary->size(), 0.0f));
+        // many more chunks than threads, 4MB chunks of huge train data
+        const std::size_t dataSize = sharedData.corpusCache ? sharedData.corpusCache->size() : _corpus->size();
+        std::size_t chunks = std::max<std::size_t>(_trainSettings->threads * 16U, dataSize / (4 * 1024 * 1024));
+        if (m_resumed) {
+            // the same chunks as the checkpointed training had, the saved position refers to them
+            if ((m_checkpoint->trainDataSize != static_cast<uint64_t>(_corpus->size() + _corpus->compressedSize()))
+                || (m_checkpoint->trainDataFiles
+                    != static_cast<uint64_t>(_corpus->files() + _corpus->compressedFiles()))) {
+                throw std::runtime_error("checkpoint does not match the train data");
+            }
+            chunks = static_cast<std::size_t>(m_checkpoint->chunks);
+        }
+        if (sharedData.corpusCache) {
+            sharedData.trainChunks.reset(new trainChunks_t(sharedData.corpusCache->data(), dataSize, chunks,
+                                                           _trainSettings->iterations));
+        } else {
+            delimiterScanner_t scanner(_trainSettings->wordDelimiterChars, _trainSettings->endOfSentenceChars);
+            sharedData.trainChunks.reset(new trainChunks_t(*_corpus, scanner, chunks, _trainSettings->iterations));
+        }
+
+        // matrix pages are placed by the threads which initialize them, the same CPUs are used by train threads
+        sharedData.bpWeights.reset(new trainMatrix_t(_trainSettings->precision, _vocabulary->size(),
+                                                     _trainSettings->size, _trainSettings->numaInterleave,
+                                                     _trainSettings->hugePages));
+        if (m_resumed) {
+            sharedData.bpWeights->copyFrom(m_checkpoint->bpWeights, _trainSettings->cpuAffinity,
+                                           _trainSettings->threads);
+        } else {
+            sharedData.bpWeights->zero(_trainSettings->cpuAffinity, _trainSettings->threads);
+            if (m_baseModel) {
+                sharedData.bpWeights->copyFrom(m_baseModel->bpWeights, _trainSettings->cpuAffinity,
+                                               _trainSettings->threads);
+            }
+        }
+        m_bpWeights = sharedData.bpWeights;
         sharedData.expTable.reset(new std::vector<float>(_trainSettings->expTableSize));
         for (uint16_t i = 0; i < _trainSettings->expTableSize; ++i) {
             // Precompute the exp() table
@@ -43,42 +101,208 @@ namespace w2v {
             (*sharedData.expTable)[i] = (*sharedData.expTable)[i] / ((*sharedData.expTable)[i] + 1.0f);
         }
 
+        std::vector<std::size_t> frequencies;
+        _vocabulary->frequencies(frequencies);
+        if (_trainSettings->sample > 0.0f) {
+            // discard thresholds are calculated once and shared by all train threads. Frequencies of an updated
+            // model are accumulated over all its train data, while train words are the words of the new data only
+            const std::size_t sampledWords = frequencies.empty() ? 0 : std::accumulate(frequencies.begin() + 1,
+                                                                                       frequencies.end(),
+                                                                                       std::size_t(0));
+            sharedData.downSampling.reset(new downSampling_t(_trainSettings->sample, sampledWords, frequencies));
+        }
+
         if (_trainSettings->withHS) {
-            std::vector<std::size_t> frequencies;
-            _vocabulary->frequencies(frequencies);
-            sharedData.huffmanTree.reset(new huffmanTree_t(frequencies));;
+            sharedData.huffmanTree.reset(new huffmanTree_t(frequencies));
         }
 
-        if (_progressCallback != nullptr) {
-            sharedData.progressCallback = _progressCallback;
+        if (!_trainSettings->withHS && (_trainSettings->negative > 0)) {
+            // alias table is built once and shared by all train threads
+            sharedData.nsDistribution.reset(new nsDistribution_t(frequencies));
         }
 
-        sharedData.processedWords.reset(new std::atomic<std::size_t>(0));
-        sharedData.alpha.reset(new std::atomic<float>(_trainSettings->alpha));
+        m_progressCallback = _progressCallback;
 
-        m_matrixSize = sharedData.trainSettings->size * sharedData.vocabulary->size();
+        sharedData.processedWords.reset(new std::vector<trainThread_t::wordsCounter_t>(_trainSettings->threads));
+        sharedData.trainedChunks.reset(new std::vector<trainThread_t::wordsCounter_t>(_trainSettings->threads));
+        for (auto &i:*sharedData.trainedChunks) {
+            i.value.store(trainThread_t::noChunk, std::memory_order_relaxed);
+        }
+        sharedData.finishedThreads.reset(new std::atomic<std::size_t>(0));
 
+        m_seed = _trainSettings->seed;
+        if (m_resumed) {
+            m_seed = m_checkpoint->seed;
+        } else if (m_seed == 0) {
+            std::random_device randomDevice;
+            m_seed = (static_cast<uint64_t>(randomDevice()) << 32U) | randomDevice();
+        }
+        sharedData.seed = m_seed;
+        if (m_resumed) {
+            sharedData.trainChunks->seek(static_cast<std::size_t>(m_checkpoint->position));
+            sharedData.resumedWords = static_cast<std::size_t>(m_checkpoint->processedWords);
+            // random streams of the resumed training differ from the ones of the interrupted training
+            sharedData.seed ^= (m_checkpoint->position + 1) * 0x9e3779b97f4a7c15ULL;
+        } else if (!_trainSettings->checkpointFile.empty()) {
+            // the vocabulary is immutable, it is copied to the checkpoint once
+            m_checkpoint.reset(new checkpoint_t());
+            m_checkpoint->seed = m_seed;
+            m_checkpoint->trainDataSize = static_cast<uint64_t>(_corpus->size() + _corpus->compressedSize());
+            m_checkpoint->trainDataFiles = static_cast<uint64_t>(_corpus->files() + _corpus->compressedFiles());
+            m_checkpoint->chunks = chunks;
+            m_checkpoint->trainWords = _vocabulary->trainWords();
+            m_checkpoint->totalWords = _vocabulary->totalWords();
+            m_checkpoint->prunedWords = _vocabulary->prunedWords();
+            std::vector<std::string> words;
+            _vocabulary->words(words);
+            m_checkpoint->words.reserve(words.size());
+            for (std::size_t i = 0; i < words.size(); ++i) {
+                m_checkpoint->words.emplace_back(std::move(words[i]), frequencies[i]);
+            }
+        }
+        m_sharedData = sharedData;
+
+        m_precision = _trainSettings->precision;
+        m_matrixRows = _vocabulary->size();
+        m_matrixSize = _trainSettings->size;
+
+        // worker with compile-time vector size or generic one, for the matrices storage format
+        auto worker = trainThread_t::specializedWorker(_trainSettings->size, _trainSettings->precision);
         for (uint8_t i = 0; i < _trainSettings->threads; ++i) {
-            m_threads.emplace_back(new trainThread_t(i, sharedData));
+            m_threads.emplace_back(new trainThread_t(i, sharedData, worker));
         }
     }
 
-    void trainer_t::operator()(std::vector<float> &_trainMatrix) noexcept {
-        // input matrix initialized with small random values
-        std::random_device randomDevice;
-        std::mt19937_64 randomGenerator(randomDevice());
-        std::uniform_real_distribution<float> rndMatrixInitializer(-0.005f, 0.005f);
-        _trainMatrix.resize(m_matrixSize);
-        std::generate(_trainMatrix.begin(), _trainMatrix.end(), [&]() {
-            return rndMatrixInitializer(randomGenerator);
-        });
+    void trainer_t::saveCheckpoint(const trainMatrix_t &_trainMatrix) noexcept {
+        try {
+            // chunks claimed after the first unfinished one are trained again on resume, the matrices copy may
+            // contain a part of their updates; private hot rows are merged when a thread finishes its chunk
+            auto position = m_sharedData.trainChunks->position();
+            for (auto const &i:*m_sharedData.trainedChunks) {
+                auto trainedChunk = i.value.load(std::memory_order_acquire);
+                if (trainedChunk < position) {
+                    position = trainedChunk;
+                }
+            }
+            m_checkpoint->position = position;
+            m_checkpoint->processedWords = trainThread_t::processedWords(m_sharedData);
+            _trainMatrix.copyTo(m_checkpoint->trainMatrix);
+            m_bpWeights->copyTo(m_checkpoint->bpWeights);
+
+            m_checkpointWritten.store(false, std::memory_order_relaxed);
+            m_checkpointWriter = std::thread([this]() {
+                try {
+                    m_checkpoint->save(m_trainSettings->checkpointFile, *m_trainSettings);
+                } catch (...) {
+                    m_checkpointError = std::current_exception();
+                }
+                m_checkpointWritten.store(true, std::memory_order_release);
+            });
+        } catch (...) {
+            m_checkpointError = std::current_exception();
+        }
+    }
+
+    void trainer_t::operator()(std::unique_ptr<trainMatrix_t> &_trainMatrix) {
+        std::unique_ptr<trainMatrix_t> trainMatrix(new trainMatrix_t(m_precision, m_matrixRows, m_matrixSize,
+                                                                     m_trainSettings->numaInterleave,
+                                                                     m_trainSettings->hugePages));
+        const bool checkpoints = !m_trainSettings->checkpointFile.empty();
+        const bool periodicCheckpoints = checkpoints && (m_trainSettings->checkpointInterval > 0);
+        if (m_resumed) {
+            trainMatrix->copyFrom(m_checkpoint->trainMatrix, m_trainSettings->cpuAffinity, m_trainSettings->threads);
+            if (!checkpoints) {
+                std::vector<std::pair<std::string, std::size_t>>().swap(m_checkpoint->words);
+                std::vector<uint8_t>().swap(m_checkpoint->trainMatrix);
+                std::vector<uint8_t>().swap(m_checkpoint->bpWeights);
+            }
+        } else {
+            // input matrix initialized with small random values
+            trainMatrix->randomize(m_seed, m_trainSettings->cpuAffinity, m_trainSettings->threads);
+            if (m_baseModel) {
+                trainMatrix->copyFrom(m_baseModel->trainMatrix, m_trainSettings->cpuAffinity,
+                                     m_trainSettings->threads);
+                m_baseModel.reset();
+            }
+        }
+
+        if (m_numaStatsCallback != nullptr) {
+            std::vector<std::size_t> pages;
+            trainMatrix->pages(pages);
+            m_bpWeights->pages(pages);
+            std::vector<std::size_t> threads(pages.size(), 0);
+            for (std::size_t i = 0; i < m_threads.size() && !m_trainSettings->cpuAffinity.empty(); ++i) {
+                auto node = numa_t::cpuNode(m_trainSettings->cpuAffinity[i % m_trainSettings->cpuAffinity.size()]);
+                if (node < threads.size()) {
+                    threads[node]++;
+                }
+            }
+            for (std::size_t i = 0; i < pages.size(); ++i) {
+                m_numaStatsCallback(i, threads[i], pages[i]);
+            }
+        }
 
         for (auto &i:m_threads) {
-            i->launch(_trainMatrix);
+            i->launch(*trainMatrix);
+        }
+
+        if ((m_progressCallback != nullptr) || periodicCheckpoints) {
+            // train threads only count their words, progress is reported and checkpoints are saved by this thread
+            const auto wordsPerAllThreads = m_trainSettings->iterations * m_sharedData.vocabulary->trainWords();
+            const std::chrono::seconds checkpointInterval(m_trainSettings->checkpointInterval);
+            auto checkpointTime = std::chrono::steady_clock::now() + checkpointInterval;
+            float prvPercent = -1.0f;
+            while (m_sharedData.finishedThreads->load(std::memory_order_acquire) < m_threads.size()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                if (m_progressCallback != nullptr) {
+                    float ratio = static_cast<float>(trainThread_t::processedWords(m_sharedData))
+                                  / wordsPerAllThreads;
+                    float percent = std::min(100.0f, ratio * 100.0f);
+                    if (percent - prvPercent >= 0.01f) {
+                        m_progressCallback(trainThread_t::alpha(*m_trainSettings, ratio), percent);
+                        prvPercent = percent;
+                    }
+                }
+
+                // the next checkpoint is not started until the previous one is written
+                if (!periodicCheckpoints || !m_checkpointWritten.load(std::memory_order_acquire)) {
+                    continue;
+                }
+                if (m_checkpointWriter.joinable()) {
+                    m_checkpointWriter.join();
+                }
+                if (m_checkpointError) {
+                    // training is stopped, it can be resumed from the previous checkpoint file which is kept
+                    m_sharedData.trainChunks->stop();
+                } else if (std::chrono::steady_clock::now() >= checkpointTime) {
+                    saveCheckpoint(*trainMatrix);
+                    checkpointTime = std::chrono::steady_clock::now() + checkpointInterval;
+                }
+            }
         }
 
         for (auto &i:m_threads) {
             i->join();
         }
+        if (m_checkpointWriter.joinable()) {
+            m_checkpointWriter.join();
+        }
+        if (checkpoints && !m_checkpointError) {
+            // the final state, the model can be updated from it
+            saveCheckpoint(*trainMatrix);
+            if (m_checkpointWriter.joinable()) {
+                m_checkpointWriter.join();
+            }
+        }
+        if (m_checkpointError) {
+            std::rethrow_exception(m_checkpointError);
+        }
+
+        // everything but the trained matrix is freed before the model is built from it
+        m_threads.clear();
+        m_sharedData = trainThread_t::sharedData_t();
+        m_bpWeights.reset();
+        m_checkpoint.reset();
+        _trainMatrix = std::move(trainMatrix);
     }
 }
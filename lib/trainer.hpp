@@ -12,42 +12,75 @@
 #include <memory>
 #include <vector>
 #include <functional>
+#include <atomic>
+#include <thread>
+#include <exception>
 
 #include "word2vec.hpp"
 #include "wordReader.hpp"
 #include "vocabulary.hpp"
+#include "trainMatrix.hpp"
 #include "trainThread.hpp"
+#include "checkpoint.hpp"
 
 namespace w2v {
     /**
      * @brief trainer class of word2vec model
      *
      * trainer class is responsible for train-specific data instantiation, train threads control and
-     * train process itself.
+     * train process itself. If checkpoints are enabled (see trainSettings_t::checkpointFile), the controlling thread
+     * copies both matrices to the checkpoint buffers periodically and a background thread writes them to the file,
+     * so train threads are not stopped while the checkpoint is saved. The final training state is saved as well,
+     * so the model can be updated with new train data later (see w2vModel_t::update()).
     */
     class trainer_t {
     private:
+        matrixPrecision_t m_precision = matrixPrecision_t::FP32;
+        std::size_t m_matrixRows = 0;
         std::size_t m_matrixSize = 0;
+        uint64_t m_seed = 0;
+        std::shared_ptr<trainSettings_t> m_trainSettings;
+        std::shared_ptr<trainMatrix_t> m_bpWeights;
+        std::function<void(std::size_t, std::size_t, std::size_t)> m_numaStatsCallback;
+        std::function<void(float, float)> m_progressCallback;
+        trainThread_t::sharedData_t m_sharedData;
         std::vector<std::unique_ptr<trainThread_t>> m_threads;
+        std::shared_ptr<checkpoint_t> m_checkpoint; // the last saved or the resumed training state
+        bool m_resumed = false;
+        std::shared_ptr<checkpoint_t> m_baseModel; // state of the updated model, released once matrices are set
+        std::thread m_checkpointWriter;
+        std::atomic<bool> m_checkpointWritten;
+        std::exception_ptr m_checkpointError;
+
+        /// copies the training state to the checkpoint and starts writing it to the file
+        void saveCheckpoint(const trainMatrix_t &_trainMatrix) noexcept;
 
     public:
         /**
          * Constructs a trainer object
          * @param _trainSettings trainSattings object
          * @param _vocabulary vocabulary object
-         * @param _fileMapper fileMapper object related to a train data set file
+         * @param _corpus train data set files
          * @param _progressCallback callback function to be called on each new 0.01% processed train data
+         * @param _numaStatsCallback callback function to be called for each NUMA node once matrices are initialized
+         * @param _checkpoint training state to resume the training from, nullptr - a new training
+         * @param _baseModel final state of a trained model to update, its matrices are initial values of the first
+         * rows of a new training, new rows are initialized as usual; nullptr - a new model
         */
         trainer_t(const std::shared_ptr<trainSettings_t> &_trainSettings,
                   const std::shared_ptr<vocabulary_t> &_vocabulary,
-                  const std::shared_ptr<fileMapper_t> &_fileMapper,
-                  std::function<void(float, float)> _progressCallback);
+                  const std::shared_ptr<corpus_t> &_corpus,
+                  std::function<void(float, float)> _progressCallback,
+                  std::function<void(std::size_t, std::size_t, std::size_t)> _numaStatsCallback = nullptr,
+                  const std::shared_ptr<checkpoint_t> &_checkpoint = nullptr,
+                  const std::shared_ptr<checkpoint_t> &_baseModel = nullptr);
 
         /**
          * Runs training process
-         * @param[out] _trainMatrix train model matrix
+         * @param[out] _trainMatrix trained input matrix, it is moved to the caller without copying
+         * @throws std::runtime_error if a checkpoint can not be saved, the training is stopped then
         */
-        void operator()(std::vector<float> &_trainMatrix) noexcept;
+        void operator()(std::unique_ptr<trainMatrix_t> &_trainMatrix);
     };
 }
 
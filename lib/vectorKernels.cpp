@@ -0,0 +1,652 @@
+/**
+ * @file
+ * @brief vector kernels - SIMD implementations of the training vector operations with runtime dispatching
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "vectorKernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define W2V_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace w2v {
+    namespace {
+        template <uint16_t size_>
+        float dotGeneric(const float *_x, const float *_y, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            float ret = 0.0f;
+            for (std::size_t i = 0; i < size; ++i) {
+                ret += _x[i] * _y[i];
+            }
+            return ret;
+        }
+
+        template <uint16_t size_>
+        void updateGeneric(float *_err, float *_w, const float *_x, float _g, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            for (std::size_t i = 0; i < size; ++i) {
+                _err[i] += _g * _w[i];
+                _w[i] += _g * _x[i];
+            }
+        }
+
+        template <uint16_t size_>
+        void gemmNTGeneric(const float *_a, const float *_b, float *_c,
+                           std::size_t _m, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            for (std::size_t i = 0; i < _m; ++i) {
+                for (std::size_t j = 0; j < _n; ++j) {
+                    _c[i * _n + j] = dotGeneric<size_>(_a + i * size, _b + j * size, size);
+                }
+            }
+        }
+
+        template <uint16_t size_>
+        void gemmNNGeneric(const float *_g, const float *_b, float *_d,
+                           std::size_t _m, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            for (std::size_t i = 0; i < _m; ++i) {
+                float *d = _d + i * size;
+                for (std::size_t k = 0; k < size; ++k) {
+                    d[k] = 0.0f;
+                }
+                for (std::size_t j = 0; j < _n; ++j) {
+                    const float g = _g[i * _n + j];
+                    const float *b = _b + j * size;
+                    for (std::size_t k = 0; k < size; ++k) {
+                        d[k] += g * b[k];
+                    }
+                }
+            }
+        }
+
+        void loadBF16Generic(const uint16_t *_src, float *_dst, std::size_t _size) {
+            for (std::size_t i = 0; i < _size; ++i) {
+                // bf16 is the high half of fp32
+                uint32_t bits = static_cast<uint32_t>(_src[i]) << 16U;
+                std::memcpy(&_dst[i], &bits, sizeof(bits));
+            }
+        }
+
+        void storeBF16Generic(uint16_t *_dst, const float *_src, const uint32_t *_noise, std::size_t _size) {
+            for (std::size_t i = 0; i < _size; ++i) {
+                uint32_t bits = 0;
+                std::memcpy(&bits, &_src[i], sizeof(bits));
+                if ((bits & 0x7f800000U) != 0x7f800000U) { // inf and NaN are truncated as is
+                    // random carry to the kept bits, then truncation
+                    bits += _noise[i] & 0xffffU;
+                }
+                _dst[i] = static_cast<uint16_t>(bits >> 16U);
+            }
+        }
+
+        void loadFP16Generic(const uint16_t *_src, float *_dst, std::size_t _size) {
+            for (std::size_t i = 0; i < _size; ++i) {
+                uint32_t sign = static_cast<uint32_t>(_src[i] & 0x8000U) << 16U;
+                uint32_t exponent = (_src[i] >> 10U) & 0x1fU;
+                uint32_t mantissa = _src[i] & 0x03ffU;
+                if (exponent == 0) { // zero or subnormal, value is mantissa * 2^-24
+                    _dst[i] = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+                    if (sign != 0) {
+                        _dst[i] = -_dst[i];
+                    }
+                    continue;
+                }
+                uint32_t bits = sign | (mantissa << 13U);
+                bits |= (exponent == 0x1fU) ? 0x7f800000U : ((exponent + 112U) << 23U); // inf/NaN or rebiased
+                std::memcpy(&_dst[i], &bits, sizeof(bits));
+            }
+        }
+
+        void storeFP16Generic(uint16_t *_dst, const float *_src, const uint32_t *_noise, std::size_t _size) {
+            for (std::size_t i = 0; i < _size; ++i) {
+                uint32_t bits = 0;
+                std::memcpy(&bits, &_src[i], sizeof(bits));
+                auto sign = static_cast<uint16_t>((bits >> 16U) & 0x8000U);
+                bits &= 0x7fffffffU;
+                if (bits >= 0x38800000U) { // fp16 normal range, 2^-14 and greater
+                    if (bits < 0x47800000U) { // inf and NaN are truncated as is
+                        // random carry to the kept bits, then truncation
+                        bits += _noise[i] & 0x1fffU;
+                    }
+                    if (bits > 0x7f800000U) {
+                        _dst[i] = static_cast<uint16_t>(sign | 0x7e00U); // NaN
+                    } else if (bits == 0x7f800000U) {
+                        _dst[i] = static_cast<uint16_t>(sign | 0x7c00U); // inf
+                    } else if (bits >= 0x47800000U) {
+                        _dst[i] = static_cast<uint16_t>(sign | 0x7bffU); // truncation overflow, max value
+                    } else {
+                        _dst[i] = static_cast<uint16_t>(sign | ((bits - 0x38000000U) >> 13U));
+                    }
+                } else { // fp16 subnormal range, value is rounded to a multiple of 2^-24
+                    float value = 0.0f;
+                    std::memcpy(&value, &bits, sizeof(bits));
+                    value = value * 16777216.0f + static_cast<float>(_noise[i] >> 8U) * (1.0f / 16777216.0f);
+                    _dst[i] = static_cast<uint16_t>(sign | static_cast<uint16_t>(value));
+                }
+            }
+        }
+
+#ifdef W2V_X86_DISPATCH
+        template <uint16_t size_>
+        __attribute__((target("sse4.1")))
+        float dotSSE41(const float *_x, const float *_y, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(_x + i), _mm_loadu_ps(_y + i)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(_x + i + 4), _mm_loadu_ps(_y + i + 4)));
+            }
+            if (i + 4 <= size) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(_x + i), _mm_loadu_ps(_y + i)));
+                i += 4;
+            }
+            acc0 = _mm_add_ps(acc0, acc1);
+            acc0 = _mm_hadd_ps(acc0, acc0);
+            acc0 = _mm_hadd_ps(acc0, acc0);
+            float ret = _mm_cvtss_f32(acc0);
+            for (auto tail = size - i; tail > 0; --tail, ++i) { // scalar tail
+                ret += _x[i] * _y[i];
+            }
+            return ret;
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("sse4.1")))
+        void updateSSE41(float *_err, float *_w, const float *_x, float _g, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            const __m128 g = _mm_set1_ps(_g);
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                __m128 w = _mm_loadu_ps(_w + i);
+                _mm_storeu_ps(_err + i, _mm_add_ps(_mm_loadu_ps(_err + i), _mm_mul_ps(g, w)));
+                _mm_storeu_ps(_w + i, _mm_add_ps(w, _mm_mul_ps(g, _mm_loadu_ps(_x + i))));
+            }
+            for (auto tail = size - i; tail > 0; --tail, ++i) { // scalar tail
+                _err[i] += _g * _w[i];
+                _w[i] += _g * _x[i];
+            }
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("avx2,fma")))
+        float dotAVX2(const float *_x, const float *_y, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(_x + i), _mm256_loadu_ps(_y + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(_x + i + 8), _mm256_loadu_ps(_y + i + 8), acc1);
+            }
+            if (i + 8 <= size) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(_x + i), _mm256_loadu_ps(_y + i), acc0);
+                i += 8;
+            }
+            acc0 = _mm256_add_ps(acc0, acc1);
+            __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+            acc = _mm_hadd_ps(acc, acc);
+            acc = _mm_hadd_ps(acc, acc);
+            float ret = _mm_cvtss_f32(acc);
+            for (auto tail = size - i; tail > 0; --tail, ++i) { // scalar tail
+                ret += _x[i] * _y[i];
+            }
+            return ret;
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("avx2,fma")))
+        void updateAVX2(float *_err, float *_w, const float *_x, float _g, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            const __m256 g = _mm256_set1_ps(_g);
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                __m256 w = _mm256_loadu_ps(_w + i);
+                _mm256_storeu_ps(_err + i, _mm256_fmadd_ps(g, w, _mm256_loadu_ps(_err + i)));
+                _mm256_storeu_ps(_w + i, _mm256_fmadd_ps(g, _mm256_loadu_ps(_x + i), w));
+            }
+            for (auto tail = size - i; tail > 0; --tail, ++i) { // scalar tail
+                _err[i] += _g * _w[i];
+                _w[i] += _g * _x[i];
+            }
+        }
+
+        // horizontal sums of 4 accumulators packed into one vector
+        __attribute__((target("avx2,fma")))
+        inline __m128 hsum4AVX2(__m256 _c0, __m256 _c1, __m256 _c2, __m256 _c3) {
+            __m256 t = _mm256_hadd_ps(_mm256_hadd_ps(_c0, _c1), _mm256_hadd_ps(_c2, _c3));
+            return _mm_add_ps(_mm256_castps256_ps128(t), _mm256_extractf128_ps(t, 1));
+        }
+
+        // 2x4 block of C = A * B^T, 8 accumulators stay in registers
+        template <uint16_t size_>
+        __attribute__((target("avx2,fma")))
+        void gemmNTAVX2(const float *_a, const float *_b, float *_c,
+                        std::size_t _m, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            const std::size_t size8 = size - size % 8;
+            std::size_t i = 0;
+            for (; i + 2 <= _m; i += 2) {
+                const float *a0 = _a + i * size;
+                const float *a1 = a0 + size;
+                std::size_t j = 0;
+                for (; j + 4 <= _n; j += 4) {
+                    const float *b0 = _b + j * size;
+                    const float *b1 = b0 + size;
+                    const float *b2 = b1 + size;
+                    const float *b3 = b2 + size;
+                    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+                    __m256 c02 = _mm256_setzero_ps(), c03 = _mm256_setzero_ps();
+                    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+                    __m256 c12 = _mm256_setzero_ps(), c13 = _mm256_setzero_ps();
+                    for (std::size_t k = 0; k < size8; k += 8) {
+                        const __m256 va0 = _mm256_loadu_ps(a0 + k);
+                        const __m256 va1 = _mm256_loadu_ps(a1 + k);
+                        __m256 vb = _mm256_loadu_ps(b0 + k);
+                        c00 = _mm256_fmadd_ps(va0, vb, c00);
+                        c10 = _mm256_fmadd_ps(va1, vb, c10);
+                        vb = _mm256_loadu_ps(b1 + k);
+                        c01 = _mm256_fmadd_ps(va0, vb, c01);
+                        c11 = _mm256_fmadd_ps(va1, vb, c11);
+                        vb = _mm256_loadu_ps(b2 + k);
+                        c02 = _mm256_fmadd_ps(va0, vb, c02);
+                        c12 = _mm256_fmadd_ps(va1, vb, c12);
+                        vb = _mm256_loadu_ps(b3 + k);
+                        c03 = _mm256_fmadd_ps(va0, vb, c03);
+                        c13 = _mm256_fmadd_ps(va1, vb, c13);
+                    }
+                    __m128 r0 = hsum4AVX2(c00, c01, c02, c03);
+                    __m128 r1 = hsum4AVX2(c10, c11, c12, c13);
+                    if (size8 < size) { // scalar tail
+                        alignas(16) float t0[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                        alignas(16) float t1[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                        for (auto k = size8; k < size; ++k) {
+                            t0[0] += a0[k] * b0[k]; t0[1] += a0[k] * b1[k];
+                            t0[2] += a0[k] * b2[k]; t0[3] += a0[k] * b3[k];
+                            t1[0] += a1[k] * b0[k]; t1[1] += a1[k] * b1[k];
+                            t1[2] += a1[k] * b2[k]; t1[3] += a1[k] * b3[k];
+                        }
+                        r0 = _mm_add_ps(r0, _mm_load_ps(t0));
+                        r1 = _mm_add_ps(r1, _mm_load_ps(t1));
+                    }
+                    _mm_storeu_ps(_c + i * _n + j, r0);
+                    _mm_storeu_ps(_c + (i + 1) * _n + j, r1);
+                }
+                for (; j < _n; ++j) {
+                    _c[i * _n + j] = dotAVX2<size_>(a0, _b + j * size, size);
+                    _c[(i + 1) * _n + j] = dotAVX2<size_>(a1, _b + j * size, size);
+                }
+            }
+            for (; i < _m; ++i) {
+                for (std::size_t j = 0; j < _n; ++j) {
+                    _c[i * _n + j] = dotAVX2<size_>(_a + i * size, _b + j * size, size);
+                }
+            }
+        }
+
+        // rows_ rows of D = G * B, one accumulator per row for each 8 columns
+        template <uint16_t size_, std::size_t rows_>
+        __attribute__((target("avx2,fma")))
+        inline void gemmNNRowsAVX2(const float *_g, const float *_b, float *_d, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            const std::size_t size8 = size - size % 8;
+            for (std::size_t k = 0; k < size8; k += 8) {
+                __m256 acc[rows_];
+                for (std::size_t r = 0; r < rows_; ++r) {
+                    acc[r] = _mm256_setzero_ps();
+                }
+                for (std::size_t j = 0; j < _n; ++j) {
+                    const __m256 vb = _mm256_loadu_ps(_b + j * size + k);
+                    for (std::size_t r = 0; r < rows_; ++r) {
+                        acc[r] = _mm256_fmadd_ps(_mm256_set1_ps(_g[r * _n + j]), vb, acc[r]);
+                    }
+                }
+                for (std::size_t r = 0; r < rows_; ++r) {
+                    _mm256_storeu_ps(_d + r * size + k, acc[r]);
+                }
+            }
+            for (auto k = size8; k < size; ++k) { // scalar tail
+                for (std::size_t r = 0; r < rows_; ++r) {
+                    float acc = 0.0f;
+                    for (std::size_t j = 0; j < _n; ++j) {
+                        acc += _g[r * _n + j] * _b[j * size + k];
+                    }
+                    _d[r * size + k] = acc;
+                }
+            }
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("avx2,fma")))
+        void gemmNNAVX2(const float *_g, const float *_b, float *_d,
+                        std::size_t _m, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            std::size_t i = 0;
+            for (; i + 4 <= _m; i += 4) {
+                gemmNNRowsAVX2<size_, 4>(_g + i * _n, _b, _d + i * size, _n, size);
+            }
+            for (; i < _m; ++i) {
+                gemmNNRowsAVX2<size_, 1>(_g + i * _n, _b, _d + i * size, _n, size);
+            }
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("avx512f")))
+        float dotAVX512(const float *_x, const float *_y, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            __m512 acc0 = _mm512_setzero_ps();
+            __m512 acc1 = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(_x + i), _mm512_loadu_ps(_y + i), acc0);
+                acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(_x + i + 16), _mm512_loadu_ps(_y + i + 16), acc1);
+            }
+            for (; i + 16 <= size; i += 16) {
+                acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(_x + i), _mm512_loadu_ps(_y + i), acc0);
+            }
+            if (i < size) { // masked tail
+                auto mask = static_cast<__mmask16>((1U << (size - i)) - 1);
+                acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, _x + i), _mm512_maskz_loadu_ps(mask, _y + i), acc1);
+            }
+            // horizontal sum via memory, 512-bit extract intrinsics trigger false uninitialized warnings in GCC
+            alignas(64) float lanes[16];
+            _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+            __m256 acc8 = _mm256_add_ps(_mm256_load_ps(lanes), _mm256_load_ps(lanes + 8));
+            __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc8), _mm256_extractf128_ps(acc8, 1));
+            acc = _mm_hadd_ps(acc, acc);
+            acc = _mm_hadd_ps(acc, acc);
+            return _mm_cvtss_f32(acc);
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("avx512f")))
+        void updateAVX512(float *_err, float *_w, const float *_x, float _g, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            const __m512 g = _mm512_set1_ps(_g);
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                __m512 w = _mm512_loadu_ps(_w + i);
+                _mm512_storeu_ps(_err + i, _mm512_fmadd_ps(g, w, _mm512_loadu_ps(_err + i)));
+                _mm512_storeu_ps(_w + i, _mm512_fmadd_ps(g, _mm512_loadu_ps(_x + i), w));
+            }
+            if (i < size) { // masked tail
+                auto mask = static_cast<__mmask16>((1U << (size - i)) - 1);
+                __m512 w = _mm512_maskz_loadu_ps(mask, _w + i);
+                _mm512_mask_storeu_ps(_err + i, mask, _mm512_fmadd_ps(g, w, _mm512_maskz_loadu_ps(mask, _err + i)));
+                _mm512_mask_storeu_ps(_w + i, mask, _mm512_fmadd_ps(g, _mm512_maskz_loadu_ps(mask, _x + i), w));
+            }
+        }
+
+        // horizontal sums of 4 accumulators packed into one vector
+        __attribute__((target("avx512f")))
+        inline __m128 hsum4AVX512(__m512 _c0, __m512 _c1, __m512 _c2, __m512 _c3) {
+            // zero-masked shuffles, unmasked ones trigger false uninitialized warnings in GCC
+            const __mmask16 all = 0xFFFF;
+            __m512 c01 = _mm512_add_ps(_mm512_maskz_shuffle_f32x4(all, _c0, _c1, _MM_SHUFFLE(1, 0, 1, 0)),
+                                       _mm512_maskz_shuffle_f32x4(all, _c0, _c1, _MM_SHUFFLE(3, 2, 3, 2)));
+            __m512 c23 = _mm512_add_ps(_mm512_maskz_shuffle_f32x4(all, _c2, _c3, _MM_SHUFFLE(1, 0, 1, 0)),
+                                       _mm512_maskz_shuffle_f32x4(all, _c2, _c3, _MM_SHUFFLE(3, 2, 3, 2)));
+            // 128-bit lane k holds partial sums of _ck
+            __m512 t = _mm512_add_ps(_mm512_maskz_shuffle_f32x4(all, c01, c23, _MM_SHUFFLE(2, 0, 2, 0)),
+                                     _mm512_maskz_shuffle_f32x4(all, c01, c23, _MM_SHUFFLE(3, 1, 3, 1)));
+            t = _mm512_add_ps(t, _mm512_maskz_permute_ps(all, t, _MM_SHUFFLE(2, 3, 0, 1)));
+            t = _mm512_add_ps(t, _mm512_maskz_permute_ps(all, t, _MM_SHUFFLE(1, 0, 3, 2)));
+            alignas(64) float lanes[16];
+            _mm512_store_ps(lanes, t);
+            return _mm_setr_ps(lanes[0], lanes[4], lanes[8], lanes[12]);
+        }
+
+        // 4x4 block of C = A * B^T, 16 accumulators stay in registers
+        template <uint16_t size_>
+        __attribute__((target("avx512f")))
+        void gemmNTAVX512(const float *_a, const float *_b, float *_c,
+                          std::size_t _m, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            const std::size_t size16 = size - size % 16;
+            const auto tailMask = static_cast<__mmask16>((1U << (size - size16)) - 1);
+            std::size_t i = 0;
+            for (; i + 4 <= _m; i += 4) {
+                const float *a[4] = {_a + i * size, _a + (i + 1) * size, _a + (i + 2) * size, _a + (i + 3) * size};
+                std::size_t j = 0;
+                for (; j + 4 <= _n; j += 4) {
+                    const float *b[4] = {_b + j * size, _b + (j + 1) * size, _b + (j + 2) * size, _b + (j + 3) * size};
+                    __m512 c[4][4];
+                    for (std::size_t r = 0; r < 4; ++r) {
+                        for (std::size_t q = 0; q < 4; ++q) {
+                            c[r][q] = _mm512_setzero_ps();
+                        }
+                    }
+                    for (std::size_t k = 0; k < size16; k += 16) {
+                        __m512 va[4];
+                        for (std::size_t r = 0; r < 4; ++r) {
+                            va[r] = _mm512_loadu_ps(a[r] + k);
+                        }
+                        for (std::size_t q = 0; q < 4; ++q) {
+                            const __m512 vb = _mm512_loadu_ps(b[q] + k);
+                            for (std::size_t r = 0; r < 4; ++r) {
+                                c[r][q] = _mm512_fmadd_ps(va[r], vb, c[r][q]);
+                            }
+                        }
+                    }
+                    if (tailMask != 0) { // masked tail
+                        __m512 va[4];
+                        for (std::size_t r = 0; r < 4; ++r) {
+                            va[r] = _mm512_maskz_loadu_ps(tailMask, a[r] + size16);
+                        }
+                        for (std::size_t q = 0; q < 4; ++q) {
+                            const __m512 vb = _mm512_maskz_loadu_ps(tailMask, b[q] + size16);
+                            for (std::size_t r = 0; r < 4; ++r) {
+                                c[r][q] = _mm512_fmadd_ps(va[r], vb, c[r][q]);
+                            }
+                        }
+                    }
+                    for (std::size_t r = 0; r < 4; ++r) {
+                        _mm_storeu_ps(_c + (i + r) * _n + j, hsum4AVX512(c[r][0], c[r][1], c[r][2], c[r][3]));
+                    }
+                }
+                for (; j < _n; ++j) {
+                    for (std::size_t r = 0; r < 4; ++r) {
+                        _c[(i + r) * _n + j] = dotAVX512<size_>(a[r], _b + j * size, size);
+                    }
+                }
+            }
+            for (; i < _m; ++i) {
+                for (std::size_t j = 0; j < _n; ++j) {
+                    _c[i * _n + j] = dotAVX512<size_>(_a + i * size, _b + j * size, size);
+                }
+            }
+        }
+
+        // rows_ rows of D = G * B, one accumulator per row for each 16 columns
+        template <uint16_t size_, std::size_t rows_>
+        __attribute__((target("avx512f")))
+        inline void gemmNNRowsAVX512(const float *_g, const float *_b, float *_d, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            for (std::size_t k = 0; k < size; k += 16) {
+                const auto mask = (size - k >= 16) ? static_cast<__mmask16>(0xFFFF)
+                                                   : static_cast<__mmask16>((1U << (size - k)) - 1);
+                __m512 acc[rows_];
+                for (std::size_t r = 0; r < rows_; ++r) {
+                    acc[r] = _mm512_setzero_ps();
+                }
+                for (std::size_t j = 0; j < _n; ++j) {
+                    const __m512 vb = _mm512_maskz_loadu_ps(mask, _b + j * size + k);
+                    for (std::size_t r = 0; r < rows_; ++r) {
+                        acc[r] = _mm512_fmadd_ps(_mm512_set1_ps(_g[r * _n + j]), vb, acc[r]);
+                    }
+                }
+                for (std::size_t r = 0; r < rows_; ++r) {
+                    _mm512_mask_storeu_ps(_d + r * size + k, mask, acc[r]);
+                }
+            }
+        }
+
+        template <uint16_t size_>
+        __attribute__((target("avx512f")))
+        void gemmNNAVX512(const float *_g, const float *_b, float *_d,
+                          std::size_t _m, std::size_t _n, std::size_t _size) {
+            const std::size_t size = (size_ > 0) ? size_ : _size;
+            std::size_t i = 0;
+            for (; i + 4 <= _m; i += 4) {
+                gemmNNRowsAVX512<size_, 4>(_g + i * _n, _b, _d + i * size, _n, size);
+            }
+            for (; i < _m; ++i) {
+                gemmNNRowsAVX512<size_, 1>(_g + i * _n, _b, _d + i * size, _n, size);
+            }
+        }
+        __attribute__((target("avx2")))
+        void loadBF16AVX2(const uint16_t *_src, float *_dst, std::size_t _size) {
+            std::size_t i = 0;
+            for (; i + 8 <= _size; i += 8) {
+                __m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_src + i)));
+                _mm256_storeu_ps(_dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16)));
+            }
+            loadBF16Generic(_src + i, _dst + i, _size - i);
+        }
+
+        __attribute__((target("avx2")))
+        void storeBF16AVX2(uint16_t *_dst, const float *_src, const uint32_t *_noise, std::size_t _size) {
+            const __m256i exponentMask = _mm256_set1_epi32(0x7f800000);
+            const __m256i noiseMask = _mm256_set1_epi32(0xffff);
+            std::size_t i = 0;
+            for (; i + 8 <= _size; i += 8) {
+                __m256i bits = _mm256_castps_si256(_mm256_loadu_ps(_src + i));
+                __m256i noise = _mm256_and_si256(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_noise + i)), noiseMask);
+                // inf and NaN are truncated as is
+                noise = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(bits, exponentMask), exponentMask),
+                                            noise);
+                bits = _mm256_srli_epi32(_mm256_add_epi32(bits, noise), 16);
+                // values are 16 bits, so the unsigned saturation of packing does not change them
+                __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + i), packed);
+            }
+            storeBF16Generic(_dst + i, _src + i, _noise + i, _size - i);
+        }
+
+        __attribute__((target("avx2,f16c")))
+        void loadFP16F16C(const uint16_t *_src, float *_dst, std::size_t _size) {
+            std::size_t i = 0;
+            for (; i + 8 <= _size; i += 8) {
+                __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_src + i));
+                _mm256_storeu_ps(_dst + i, _mm256_cvtph_ps(bits));
+            }
+            loadFP16Generic(_src + i, _dst + i, _size - i);
+        }
+
+        __attribute__((target("avx2,f16c")))
+        void storeFP16F16C(uint16_t *_dst, const float *_src, const uint32_t *_noise, std::size_t _size) {
+            const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+            const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x80000000U)));
+            const __m256 minNormal = _mm256_set1_ps(6.103515625e-05f); // 2^-14
+            const __m256 maxValue = _mm256_set1_ps(65536.0f);
+            const __m256i noiseMask = _mm256_set1_epi32(0x1fff);
+            const __m256 noiseScale = _mm256_set1_ps(1.0f / 16777216.0f / 16777216.0f);
+            std::size_t i = 0;
+            for (; i + 8 <= _size; i += 8) {
+                __m256 value = _mm256_loadu_ps(_src + i);
+                __m256 absValue = _mm256_and_ps(value, absMask);
+                __m256i noise = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_noise + i));
+                // normal range - random carry to the kept bits
+                __m256 normal = _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(value),
+                                                                     _mm256_and_si256(noise, noiseMask)));
+                // subnormal range - random addition less than 2^-24 (subnormal step)
+                __m256 subnormal = _mm256_add_ps(value, _mm256_or_ps(
+                        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(noise, 8)), noiseScale),
+                        _mm256_and_ps(value, signMask)));
+                __m256 rounded = _mm256_blendv_ps(normal, subnormal, _mm256_cmp_ps(absValue, minNormal, _CMP_LT_OQ));
+                // values out of the fp16 range, inf and NaN are truncated as is
+                rounded = _mm256_blendv_ps(rounded, value, _mm256_cmp_ps(absValue, maxValue, _CMP_NLT_UQ));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(_dst + i), _mm256_cvtps_ph(rounded, _MM_FROUND_TO_ZERO));
+            }
+            storeFP16Generic(_dst + i, _src + i, _noise + i, _size - i);
+        }
+#endif
+
+        // kernel sets supported by CPU, from the generic set to the best one
+        template <uint16_t size_>
+        std::vector<vectorKernels_t> supportedKernels() {
+            std::vector<vectorKernels_t> ret;
+            ret.push_back({dotGeneric<size_>, updateGeneric<size_>, gemmNTGeneric<size_>, gemmNNGeneric<size_>,
+                           loadBF16Generic, storeBF16Generic, loadFP16Generic, storeFP16Generic, "generic"});
+#ifdef W2V_X86_DISPATCH
+            __builtin_cpu_init();
+            vectorKernels_t set = ret.front();
+            // 16-bit row codecs do not depend on the arithmetic kernels, SIMD sets use the best ones
+            if (__builtin_cpu_supports("avx2")) {
+                set.loadBF16 = loadBF16AVX2;
+                set.storeBF16 = storeBF16AVX2;
+            }
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) {
+                set.loadFP16 = loadFP16F16C;
+                set.storeFP16 = storeFP16F16C;
+            }
+            if (__builtin_cpu_supports("sse4.1")) {
+                set.dot = dotSSE41<size_>;
+                set.update = updateSSE41<size_>;
+                set.name = "SSE4.1";
+                ret.push_back(set);
+            }
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                set.dot = dotAVX2<size_>;
+                set.update = updateAVX2<size_>;
+                set.gemmNT = gemmNTAVX2<size_>;
+                set.gemmNN = gemmNNAVX2<size_>;
+                set.name = "AVX2";
+                ret.push_back(set);
+            }
+            if (__builtin_cpu_supports("avx512f")) {
+                set.dot = dotAVX512<size_>;
+                set.update = updateAVX512<size_>;
+                set.gemmNT = gemmNTAVX512<size_>;
+                set.gemmNN = gemmNNAVX512<size_>;
+                set.name = "AVX-512";
+                ret.push_back(set);
+            }
+#endif
+            return ret;
+        }
+
+        template <uint16_t size_>
+        const vectorKernels_t &kernels() noexcept {
+            static const vectorKernels_t kernels = supportedKernels<size_>().back();
+            return kernels;
+        }
+    }
+
+    const vectorKernels_t &vectorKernels_t::instance(uint16_t _size) noexcept {
+        // the same vector sizes are specialized by trainThread_t
+        switch (_size) {
+            case 50: return kernels<50>();
+            case 100: return kernels<100>();
+            case 128: return kernels<128>();
+            case 200: return kernels<200>();
+            case 256: return kernels<256>();
+            case 300: return kernels<300>();
+            case 500: return kernels<500>();
+            default: return kernels<0>();
+        }
+    }
+
+    std::vector<vectorKernels_t> vectorKernels_t::supported(uint16_t _size) {
+        switch (_size) {
+            case 50: return supportedKernels<50>();
+            case 100: return supportedKernels<100>();
+            case 128: return supportedKernels<128>();
+            case 200: return supportedKernels<200>();
+            case 256: return supportedKernels<256>();
+            case 300: return supportedKernels<300>();
+            case 500: return supportedKernels<500>();
+            default: return supportedKernels<0>();
+        }
+    }
+}
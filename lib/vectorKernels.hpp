@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief vector kernels - SIMD implementations of the training vector operations with runtime dispatching
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_VECTORKERNELS_H
+#define WORD2VEC_VECTORKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace w2v {
+    /**
+     * @brief vectorKernels structure - a set of vector operations used by the training hot path
+     *
+     * Both Negative Sampling and Hierarchical Softmax do the same sequence for every target word: a dot product of
+     * the hidden layer and the target output weights, then accumulation of the hidden layer errors and update of
+     * the output weights. The dot product and the fused errors/weights update are implemented for AVX-512, AVX2/FMA,
+     * SSE4.1 and generic CPUs. The best implementation is selected once at runtime by CPUID, so the same binary
+     * runs at full speed on any x86 CPU. Kernels are also specialized for the most common vector sizes, so their
+     * loops have compile-time trip counts.
+     * Small dense matrix products (register-blocked GEMM micro-kernels) are used by the batched Skip-Gram mode, where
+     * all context words of a window are trained against the same set of target and negative words at once.
+     * Row codecs convert bf16/fp16 matrix rows to fp32 before the computations and back after them. Conversion to
+     * 16 bits uses stochastic rounding, so small updates are not lost on the write-back but applied with a
+     * probability proportional to their size.
+    */
+    struct vectorKernels_t final {
+        /// kernel implementing dot product of _x and _y vectors
+        using dot_t = float (*)(const float *_x, const float *_y, std::size_t _size);
+        /// kernel implementing fused update: _err[i] += _g * _w[i]; _w[i] += _g * _x[i]
+        using update_t = void (*)(float *_err, float *_w, const float *_x, float _g, std::size_t _size);
+
+        /// kernel implementing _c = _a * _b^T, where _a is _m x _size, _b is _n x _size, _c is _m x _n (row-major)
+        using gemmNT_t = void (*)(const float *_a, const float *_b, float *_c,
+                                  std::size_t _m, std::size_t _n, std::size_t _size);
+        /// kernel implementing _d = _g * _b, where _g is _m x _n, _b is _n x _size, _d is _m x _size (row-major)
+        using gemmNN_t = void (*)(const float *_g, const float *_b, float *_d,
+                                  std::size_t _m, std::size_t _n, std::size_t _size);
+
+        /// kernel converting 16-bit floats (bf16 or fp16) to fp32 values
+        using load16_t = void (*)(const uint16_t *_src, float *_dst, std::size_t _size);
+        /// kernel converting fp32 values to 16-bit floats (bf16 or fp16), _noise holds 32 random bits per value
+        using store16_t = void (*)(uint16_t *_dst, const float *_src, const uint32_t *_noise, std::size_t _size);
+
+        dot_t dot; ///< dot product kernel
+        update_t update; ///< fused errors accumulation and weights update kernel
+        gemmNT_t gemmNT; ///< matrix by transposed matrix product kernel
+        gemmNN_t gemmNN; ///< matrix by matrix product kernel
+        load16_t loadBF16; ///< bf16 to fp32 conversion kernel
+        store16_t storeBF16; ///< fp32 to bf16 conversion kernel, stochastic rounding
+        load16_t loadFP16; ///< fp16 to fp32 conversion kernel
+        store16_t storeFP16; ///< fp32 to fp16 conversion kernel, stochastic rounding
+        const char *name; ///< instruction set name of the kernels
+
+        /**
+         * Selects the kernels set on the first call
+         * @param _size vector size, kernels specialized for this size are returned if available
+         * @returns kernels set implemented with the best instruction set supported by CPU
+        */
+        static const vectorKernels_t &instance(uint16_t _size) noexcept;
+
+        /**
+         * Lists all kernels sets the CPU can run, so they can be verified against each other
+         * @param _size vector size, kernels specialized for this size are returned if available
+         * @returns kernels sets from the generic one to the one returned by instance()
+        */
+        static std::vector<vectorKernels_t> supported(uint16_t _size);
+    };
+}
+
+#endif // WORD2VEC_VECTORKERNELS_H
@@ -6,17 +6,81 @@
  * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
 */
 
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include "vocabulary.hpp"
 #include "wordReader.hpp"
+#include "trainChunks.hpp"
+#include "gzipReader.hpp"
 
 namespace w2v {
-    vocabulary_t::vocabulary_t(std::shared_ptr<fileMapper_t> &_trainWordsMapper,
-                               std::shared_ptr<fileMapper_t> &_stopWordsMapper,
+    namespace {
+        /// sorts chunks of the range in parallel, then merges sorted chunks pairwise in parallel
+        template <class iterator_t, class compare_t>
+        void parallelSort(iterator_t _begin, iterator_t _end, compare_t _cmp, std::size_t _threads) {
+            const auto size = static_cast<std::size_t>(_end - _begin);
+            std::size_t chunks = std::max<std::size_t>(1, std::min(_threads, size / 16384));
+            std::vector<iterator_t> bounds;
+            for (std::size_t i = 0; i <= chunks; ++i) {
+                bounds.push_back(_begin + static_cast<std::ptrdiff_t>(size * i / chunks));
+            }
+
+            std::vector<std::thread> threads;
+            for (std::size_t i = 0; i < chunks; ++i) {
+                threads.emplace_back([&bounds, &_cmp, i]() {
+                    std::sort(bounds[i], bounds[i + 1], _cmp);
+                });
+            }
+            for (auto &i:threads) {
+                i.join();
+            }
+
+            for (std::size_t step = 1; step < chunks; step *= 2) {
+                threads.clear();
+                for (std::size_t i = 0; i + step < chunks; i += step * 2) {
+                    threads.emplace_back([&bounds, &_cmp, i, step, chunks]() {
+                        std::inplace_merge(bounds[i], bounds[i + step], bounds[std::min(i + step * 2, chunks)], _cmp);
+                    });
+                }
+                for (auto &i:threads) {
+                    i.join();
+                }
+            }
+        }
+    }
+
+    std::size_t vocabulary_t::reduce(std::unordered_map<std::string, std::size_t> &_words,
+                                     std::size_t _maxWords, std::size_t &_threshold) noexcept {
+        // the original word2vec ReduceVocab approach - remove the rarest words, raise the threshold for the next time
+        std::size_t ret = 0;
+        while (_words.size() > _maxWords) {
+            for (auto i = _words.begin(); i != _words.end();) {
+                if (i->second <= _threshold) {
+                    ret += i->second;
+                    i = _words.erase(i);
+                } else {
+                    ++i;
+                }
+            }
+            _threshold++;
+        }
+        return ret;
+    }
+
+    vocabulary_t::vocabulary_t(const std::shared_ptr<corpus_t> &_corpus,
+                               const std::shared_ptr<fileMapper_t> &_stopWordsMapper,
                                const std::string &_wordDelimiterChars,
                                const std::string &_endOfSentenceChars,
                                uint16_t _minFreq,
-                               w2vModel_t::vocabularyProgressCallback_t _progressCallback,
-                               w2vModel_t::vocabularyStatsCallback_t _statsCallback) noexcept: m_words() {
+                               uint8_t _threads,
+                               uint8_t _decompressionThreads,
+                               std::size_t _maxDistinctWords,
+                               w2vModel_t::vocabularyProgressCallback_t _progressCallback):
+            m_words(), m_arena(), m_offsets(), m_slots() {
         // load stop-words
         std::vector<std::string> stopWords;
         if (_stopWordsMapper) {
@@ -27,49 +91,162 @@ namespace w2v {
             }
         }
 
-        // load words and calculate their frequencies
-        struct tmpWordData_t {
-            std::size_t frequency = 0;
-            std::string word;
-        };
-        std::unordered_map<std::string, tmpWordData_t> tmpWords;
-        off_t progressOffset = 0;
-        if (_trainWordsMapper) {
-            wordReader_t<fileMapper_t> wordReader(*_trainWordsMapper, _wordDelimiterChars, _endOfSentenceChars);
-            std::string word;
-            while (wordReader.nextWord(word)) {
-                if (word.empty()) {
-                    word = "</s>";
-                }
-                auto &i = tmpWords[word];
-                if (i.frequency == 0) {
-                    i.word = word;
+        // load words and calculate their frequencies, each thread counts its own part of the train data
+        const std::size_t threadsNumber = std::max<std::size_t>(1, _threads);
+        std::vector<std::unordered_map<std::string, std::size_t>> tmpWords(threadsNumber);
+        std::vector<std::size_t> totalWords(threadsNumber, 0);
+        std::vector<std::size_t> prunedWords(threadsNumber, 0);
+        std::vector<std::size_t> thresholds(threadsNumber, 1);
+        if (_corpus) {
+            // chunks are aligned to word boundaries and never span two files, each thread counts a contiguous range
+            // of chunks, so pruned words do not depend on the order threads run in
+            const delimiterScanner_t scanner(_wordDelimiterChars, _endOfSentenceChars);
+            const std::size_t size = _corpus->size();
+            const trainChunks_t chunks(*_corpus, scanner,
+                                       std::max<std::size_t>(threadsNumber * 16, size / (4 * 1024 * 1024)), 1);
+            // compressed files are decoded by dedicated threads, each thread counts its share of decoded blocks after its
+            // chunks
+            std::unique_ptr<gzipReader_t> gzipReader;
+            if (_corpus->compressedFiles() > 0) {
+                gzipReader.reset(new gzipReader_t(*_corpus, scanner, _decompressionThreads, threadsNumber,
+                                                  threadsNumber * 2));
+            }
+
+            std::atomic<std::size_t> processed(0);
+            std::mutex progressMutex;
+            const std::size_t progressSize = size + _corpus->compressedSize();
+            const std::size_t progressStep = std::max<std::size_t>(1, progressSize / 10000);
+            auto gzipProcessed = [&gzipReader]() -> std::size_t {
+                return gzipReader ? gzipReader->processed() : 0;
+            };
+            std::vector<std::exception_ptr> errors(threadsNumber);
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0; t < threadsNumber; ++t) {
+                const std::size_t firstChunk = chunks.size() * t / threadsNumber;
+                const std::size_t lastChunk = chunks.size() * (t + 1) / threadsNumber;
+                if ((firstChunk >= lastChunk) && !gzipReader) {
+                    continue;
                 }
-                i.frequency++;
-                m_totalWords++;
-
-                if (_progressCallback != nullptr) {
-                    if (wordReader.offset() - progressOffset >= _trainWordsMapper->size() / 10000 - 1) {
-                        _progressCallback(static_cast<float>(wordReader.offset())
-                                          / _trainWordsMapper->size() * 100.0f);
-                        progressOffset = wordReader.offset();
+                threads.emplace_back([&, t, firstChunk, lastChunk]() {
+                    auto &words = tmpWords[t];
+                    std::size_t progressOffset = chunks.bound(firstChunk);
+                    const char *wordPtr = nullptr;
+                    std::size_t length = 0;
+                    std::string word;
+                    // _offset is the corpus offset of a mapped file, decoded blocks have no offset
+                    auto count = [&](wordReader_t<mapper_t> &_wordReader, bool _mapped, std::size_t _offset) {
+                        while (_wordReader.nextWord(wordPtr, length)) {
+                            if (length == 0) {
+                                continue; // sentence delimiters are not counted
+                            }
+                            word.assign(wordPtr, length);
+                            words[word]++;
+                            totalWords[t]++;
+                            if ((_maxDistinctWords > 0) && (words.size() > _maxDistinctWords)) {
+                                // pruned with a margin, so pruning is not repeated on each new word
+                                prunedWords[t] += reduce(words, _maxDistinctWords / 4 * 3, thresholds[t]);
+                            }
+
+                            if (!_mapped || (_progressCallback == nullptr)) {
+                                continue;
+                            }
+                            const auto position = _offset + static_cast<std::size_t>(_wordReader.offset());
+                            if (position - progressOffset >= progressStep) {
+                                processed += position - progressOffset;
+                                progressOffset = position;
+                                std::lock_guard<std::mutex> lock(progressMutex);
+                                _progressCallback(static_cast<float>(processed + gzipProcessed())
+                                                  / progressSize * 100.0f);
+                            }
+                        }
+                    };
+
+                    try {
+                        for (auto c = firstChunk; c < lastChunk; ++c) {
+                            const auto from = chunks.bound(c);
+                            const auto file = _corpus->fileAt(from);
+                            const auto offset = _corpus->offset(file);
+                            wordReader_t<mapper_t> wordReader(_corpus->file(file), _wordDelimiterChars,
+                                                              _endOfSentenceChars,
+                                                              range_t{static_cast<off_t>(from - offset),
+                                                                      static_cast<off_t>(chunks.bound(c + 1) - offset)});
+                            count(wordReader, true, offset);
+                        }
+
+                        // decoded blocks are dealt to threads in the text order, their progress is compressed bytes
+                        // decoded
+                        std::string block;
+                        while (gzipReader && gzipReader->next(t, block)) {
+                            stringMapper_t mapper(block);
+                            wordReader_t<mapper_t> wordReader(mapper, _wordDelimiterChars, _endOfSentenceChars);
+                            count(wordReader, false, 0);
+                            if (_progressCallback != nullptr) {
+                                std::lock_guard<std::mutex> lock(progressMutex);
+                                _progressCallback(static_cast<float>(processed + gzipProcessed())
+                                                  / progressSize * 100.0f);
+                            }
+                        }
+                    } catch (...) {
+                        errors[t] = std::current_exception();
+                        // the blocks of this thread are never taken, the other threads must not wait for them
+                        if (gzipReader) {
+                            gzipReader->stop();
+                        }
                     }
+                });
+            }
+            for (auto &i:threads) {
+                i.join();
+            }
+            for (auto const &i:errors) {
+                if (i) {
+                    std::rethrow_exception(i);
                 }
             }
+
+            // merge thread local counters pairwise in parallel
+            for (std::size_t step = 1; step < threadsNumber; step *= 2) {
+                threads.clear();
+                for (std::size_t i = 0; i + step < threadsNumber; i += step * 2) {
+                    threads.emplace_back([&, i, step]() {
+                        auto &to = tmpWords[i];
+                        for (auto const &j:tmpWords[i + step]) {
+                            to[j.first] += j.second;
+                        }
+                        std::unordered_map<std::string, std::size_t>().swap(tmpWords[i + step]);
+                        prunedWords[i] += prunedWords[i + step];
+                        thresholds[i] = std::max(thresholds[i], thresholds[i + step]);
+                        if (_maxDistinctWords > 0) {
+                            prunedWords[i] += reduce(to, _maxDistinctWords, thresholds[i]);
+                        }
+                    });
+                }
+                for (auto &i:threads) {
+                    i.join();
+                }
+            }
+        }
+        auto &words = tmpWords[0];
+        if (_maxDistinctWords > 0) {
+            prunedWords[0] += reduce(words, _maxDistinctWords, thresholds[0]);
+        }
+        m_prunedWords = prunedWords[0];
+        for (auto i:totalWords) {
+            m_totalWords += i;
         }
 
         // remove stop words from the words set
         for (auto &i:stopWords) {
-            tmpWords.erase(i);
+            words.erase(i);
         }
 
         // remove sentence delimiter from the words set
         {
             std::string word = "</s>";
-            auto i = tmpWords.find(word);
-            if (i != tmpWords.end()) {
-                m_totalWords -= i->second.frequency;
-                tmpWords.erase(i);
+            auto i = words.find(word);
+            if (i != words.end()) {
+                m_totalWords -= i->second;
+                words.erase(i);
             }
         }
 
@@ -77,34 +254,105 @@ namespace w2v {
         std::vector<std::pair<std::string, std::size_t>> wordsFreq;
         // delimiter is the first word
         wordsFreq.emplace_back(std::pair<std::string, std::size_t>("</s>", 0LU));
-        for (auto const &i:tmpWords) {
-            if (i.second.frequency >= _minFreq) {
-                wordsFreq.emplace_back(std::pair<std::string, std::size_t>(i.first, i.second.frequency));
-                m_trainWords += i.second.frequency;
+        for (auto const &i:words) {
+            if (i.second >= _minFreq) {
+                wordsFreq.emplace_back(std::pair<std::string, std::size_t>(i.first, i.second));
+                m_trainWords += i.second;
             }
         }
+        std::unordered_map<std::string, std::size_t>().swap(words);
 
         // sorting, from more frequent to less frequent, skip delimiter </s> (first word)
         if (wordsFreq.size() > 1) {
-            std::sort(wordsFreq.begin() + 1, wordsFreq.end(), [](const std::pair<std::string, std::size_t> &_what,
-                                                                 const std::pair<std::string, std::size_t>&_with) {
-                return _what.second > _with.second;
-            });
+            // words with the same frequency are ordered alphabetically, so indexes do not depend on threads number
+            parallelSort(wordsFreq.begin() + 1, wordsFreq.end(), [](const std::pair<std::string, std::size_t> &_what,
+                                                                    const std::pair<std::string, std::size_t>&_with) {
+                return (_what.second > _with.second) || ((_what.second == _with.second) && (_what.first < _with.first));
+            }, threadsNumber);
             // make delimiter frequency more then the most frequent word
             wordsFreq[0].second = wordsFreq[1].second + 1;
-            // restore sentence delimiter
-            auto &i = tmpWords["</s>"];
-            i.word = "</s>";
-            i.frequency = wordsFreq[0].second;
         }
-        // fill index values
-        for (std::size_t i = 0; i < wordsFreq.size(); ++i) {
-            auto &w = tmpWords[wordsFreq[i].first];
-            m_words[wordsFreq[i].first] = wordData_t(i, w.frequency);
+        // fill index values and build the lookup table
+        freeze(wordsFreq);
+    }
+
+    vocabulary_t::vocabulary_t(const std::vector<std::pair<std::string, std::size_t>> &_words,
+                               std::size_t _trainWords, std::size_t _totalWords, std::size_t _prunedWords):
+            m_trainWords(_trainWords), m_totalWords(_totalWords), m_prunedWords(_prunedWords),
+            m_words(), m_arena(), m_offsets(), m_slots() {
+        freeze(_words);
+    }
+
+    vocabulary_t::vocabulary_t(const std::vector<std::pair<std::string, std::size_t>> &_baseWords,
+                               const vocabulary_t &_newWords, uint16_t _minFreq):
+            m_totalWords(_newWords.m_totalWords), m_prunedWords(_newWords.m_prunedWords),
+            m_words(), m_arena(), m_offsets(), m_slots() {
+        std::vector<std::pair<std::string, std::size_t>> wordsFreq(_baseWords);
+        if (wordsFreq.empty()) {
+            wordsFreq.emplace_back(std::pair<std::string, std::size_t>("</s>", 0LU));
+        }
+        // words of the trained model, the first one is the delimiter </s>
+        vocabulary_t base(wordsFreq, 0, 0, 0);
+        for (std::size_t i = 1; i < wordsFreq.size(); ++i) {
+            auto wordData = _newWords.data(wordsFreq[i].first);
+            if (wordData != nullptr) {
+                wordsFreq[i].second += wordData->frequency;
+                m_trainWords += wordData->frequency;
+            }
+        }
+        // new words are ordered by their frequencies already
+        for (std::size_t i = 1; i < _newWords.m_words.size(); ++i) {
+            auto frequency = _newWords.m_words[i].frequency;
+            if (frequency < _minFreq) {
+                break;
+            }
+            std::string word(_newWords.m_arena.data() + _newWords.m_offsets[i],
+                             _newWords.m_offsets[i + 1] - _newWords.m_offsets[i]);
+            if (base.data(word) == nullptr) {
+                wordsFreq.emplace_back(std::move(word), frequency);
+                m_trainWords += frequency;
+            }
+        }
+
+        // make delimiter frequency more then the most frequent word
+        std::size_t maxFrequency = 0;
+        for (std::size_t i = 1; i < wordsFreq.size(); ++i) {
+            maxFrequency = std::max(maxFrequency, wordsFreq[i].second);
+        }
+        wordsFreq[0].second = maxFrequency + 1;
+        freeze(wordsFreq);
+    }
+
+    void vocabulary_t::freeze(const std::vector<std::pair<std::string, std::size_t>> &_words) {
+        std::size_t arenaSize = 0;
+        for (auto const &i:_words) {
+            arenaSize += i.first.size();
+        }
+        m_words.reserve(_words.size());
+        m_arena.reserve(arenaSize);
+        m_offsets.reserve(_words.size() + 1);
+        m_offsets.push_back(0);
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            m_words.emplace_back(i, _words[i].second);
+            m_arena.insert(m_arena.end(), _words[i].first.begin(), _words[i].first.end());
+            m_offsets.push_back(m_arena.size());
         }
 
-        if (_statsCallback != nullptr) {
-            _statsCallback(m_words.size(), m_trainWords, m_totalWords);
+        // table load factor is kept below 0.75
+        std::size_t slots = 16;
+        while (slots < _words.size() + _words.size() / 3 + 1) {
+            slots <<= 1U;
+        }
+        m_slots.assign(slots, slot_t{0, 0});
+        m_slotsMask = slots - 1;
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            auto wordHash = hash(_words[i].first.data(), _words[i].first.size());
+            auto j = static_cast<std::size_t>(wordHash) & m_slotsMask;
+            while (m_slots[j].index != 0) {
+                j = (j + 1) & m_slotsMask;
+            }
+            m_slots[j].tag = static_cast<uint32_t>(wordHash >> 32U);
+            m_slots[j].index = static_cast<uint32_t>(i + 1);
         }
     }
 }
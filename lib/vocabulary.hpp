@@ -8,6 +8,8 @@
 #ifndef WORD2VEC_VOCABULARY_H
 #define WORD2VEC_VOCABULARY_H
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,14 +18,16 @@
 
 #include "word2vec.hpp"
 #include "mapper.hpp"
+#include "corpus.hpp"
 
 namespace w2v {
     /**
      * @brief vocabulary class - implements fast access to a words storage with their data - index and frequency.
      *
      * Vocabulary contains parsed words with minimum defined frequency, excluding stop words defined in a text file.
-     * Base word storage is the std::unordered_map object.
-     *
+     * Vocabulary is immutable after construction, so it is frozen into a compact open-addressing hash table.
+     * Words are stored in one contiguous string arena in index order, each table slot holds a part of the word hash
+     * and the word index, so a lookup compares strings only on a hash match and no std::string is needed for a key.
     */
     class vocabulary_t final {
     public:
@@ -42,45 +46,143 @@ namespace w2v {
         };
 
     private:
-        // word (key) with its index and frequency
-        using wordMap_t = std::unordered_map<std::string, wordData_t>;
+        /// hash table slot
+        struct slot_t final {
+            uint32_t tag; ///< high 32 bits of the word hash
+            uint32_t index; ///< word index + 1, 0 - empty slot
+        };
 
         std::size_t m_trainWords = 0;
         std::size_t m_totalWords = 0;
+        std::size_t m_prunedWords = 0;
+
+        std::vector<wordData_t> m_words; // word data by word index
+        std::vector<char> m_arena; // words in index order
+        std::vector<std::size_t> m_offsets; // word positions in the arena, m_offsets[i + 1] is the end of i-th word
+        std::vector<slot_t> m_slots; // open-addressing hash table, linear probing
+        std::size_t m_slotsMask = 0;
+
+        static inline uint64_t hash(const char *_word, std::size_t _length) noexcept {
+            uint64_t ret = 0x9e3779b97f4a7c15ULL ^ (_length * 0xff51afd7ed558ccdULL);
+            std::size_t i = 0;
+            uint64_t value = 0;
+            for (; i + sizeof(value) <= _length; i += sizeof(value)) {
+                std::memcpy(&value, _word + i, sizeof(value));
+                ret = (ret ^ (value * 0x87c37b91114253d5ULL)) * 0x4cf5ad432745937fULL;
+                ret ^= ret >> 29U;
+            }
+            value = 0;
+            std::memcpy(&value, _word + i, _length - i);
+            ret = (ret ^ (value * 0x87c37b91114253d5ULL)) * 0x4cf5ad432745937fULL;
+            // murmur3 finalizer
+            ret ^= ret >> 33U;
+            ret *= 0xff51afd7ed558ccdULL;
+            ret ^= ret >> 33U;
+            ret *= 0xc4ceb9fe1a85ec53ULL;
+            ret ^= ret >> 33U;
+            return ret;
+        }
 
-        wordMap_t m_words;
+        /// builds the arena and the hash table from words sorted by their indexes
+        void freeze(const std::vector<std::pair<std::string, std::size_t>> &_words);
 
     public:
+        /**
+         * Removes the rarest words until the words number is not greater than _maxWords
+         * @param[in,out] _words words and their frequencies
+         * @param _maxWords max words number
+         * @param[in,out] _threshold words with frequency not greater than _threshold are removed, it is raised after
+         * each removal
+         * @returns sum of frequencies of the removed words
+        */
+        static std::size_t reduce(std::unordered_map<std::string, std::size_t> &_words,
+                                  std::size_t _maxWords, std::size_t &_threshold) noexcept;
+
         /**
          * Constructs a vocabulary object from the specified files and parameters
-         * @param _trainWordsMapper smart pointer to fileMapper object related to a train data set file
+         * @param _corpus smart pointer to the train data set
          * @param _stopWordsMapper smart pointer to fileMapper object related to a file with stop-words.
          * In case of unititialized pointer, _stopWordsMapper will be ignored.
          * @param _minFreq minimum word frequency to include into vocabulary
+         * @param _threads number of threads counting words, each thread counts its own chunks of the train data
+         * @param _decompressionThreads number of threads decoding compressed files, their decoded blocks are counted
+         * by the counting threads after their chunks
+         * @param _maxDistinctWords max number of distinct words counted by each thread and kept after merging, the
+         * rarest words are pruned with a rising frequency threshold when it is exceeded, 0 - no limit
          * @param _progressCallback callback function to be called on each new 0.01% processed train data
-         * @param _statsCallback callback function to be called on train data loaded event to pass vocabulary size,
-         * train words and total words amounts.
+         * @throws std::runtime_error In case of corrupted compressed train data
         */
-        vocabulary_t(std::shared_ptr<fileMapper_t> &_trainWordsMapper,
-                     std::shared_ptr<fileMapper_t> &_stopWordsMapper,
+        vocabulary_t(const std::shared_ptr<corpus_t> &_corpus,
+                     const std::shared_ptr<fileMapper_t> &_stopWordsMapper,
                      const std::string &_wordDelimiterChars,
                      const std::string &_endOfSentenceChars,
                      uint16_t _minFreq,
-                     w2vModel_t::vocabularyProgressCallback_t _progressCallback,
-                     w2vModel_t::vocabularyStatsCallback_t _statsCallback) noexcept;
+                     uint8_t _threads,
+                     uint8_t _decompressionThreads,
+                     std::size_t _maxDistinctWords,
+                     w2vModel_t::vocabularyProgressCallback_t _progressCallback);
+
+        /**
+         * Constructs a vocabulary object from words saved before, see checkpoint_t
+         * @param _words words in index order and their frequencies
+         * @param _trainWords train words amount
+         * @param _totalWords total words amount
+         * @param _prunedWords pruned words amount
+        */
+        vocabulary_t(const std::vector<std::pair<std::string, std::size_t>> &_words,
+                     std::size_t _trainWords, std::size_t _totalWords, std::size_t _prunedWords);
+
+        /**
+         * Constructs a vocabulary object extending words of a trained model with words of a new train data set.
+         * Words of the trained model keep their indexes and all of them are trained, their frequencies are
+         * accumulated. New words with minimum defined frequency are appended in the order of their indexes.
+         * @param _baseWords words of the trained model in index order and their frequencies, see checkpoint_t
+         * @param _newWords vocabulary of the new train data set, built with minimum frequency 1
+         * @param _minFreq minimum frequency of a new word to include into vocabulary
+        */
+        vocabulary_t(const std::vector<std::pair<std::string, std::size_t>> &_baseWords,
+                     const vocabulary_t &_newWords, uint16_t _minFreq);
 
         /**
-         * Requests a data (index, frequency, word) associated with the _word
+         * Requests a data (index, frequency) associated with the word
+         * @param[in] _word pointer to the word chars
+         * @param[in] _length word length
+         * @return pointer to a wordData object or nullptr if the word is not a member of vocabulary
+        */
+        inline const wordData_t *data(const char *_word, std::size_t _length) const noexcept {
+            auto wordHash = hash(_word, _length);
+            auto tag = static_cast<uint32_t>(wordHash >> 32U);
+            for (auto i = static_cast<std::size_t>(wordHash) & m_slotsMask; ; i = (i + 1) & m_slotsMask) {
+                const auto &slot = m_slots[i];
+                if (slot.index == 0) {
+                    return nullptr;
+                }
+                if (slot.tag == tag) {
+                    auto offset = m_offsets[slot.index - 1];
+                    if ((m_offsets[slot.index] - offset == _length)
+                        && (std::memcmp(&m_arena[offset], _word, _length) == 0)) {
+                        return &m_words[slot.index - 1];
+                    }
+                }
+            }
+        }
+
+        /**
+         * Requests a data (index, frequency) associated with the _word
          * @param[in] _word key value
          * @return pointer to a wordData object or nullptr if the word is not a member of vocabulary
         */
         inline const wordData_t *data(const std::string &_word) const noexcept {
-            auto i = m_words.find(_word);
-            if (i != m_words.end()) {
-                return &(i->second);
-            } else {
-                return nullptr;
-            }
+            return data(_word.data(), _word.size());
+        }
+
+        /**
+         * Requests a data (index, frequency) associated with the word index
+         * @param[in] _index word index
+         * @return pointer to a wordData object or nullptr if the index is out of vocabulary
+        */
+        inline const wordData_t *data(std::size_t _index) const noexcept {
+            return (_index < m_words.size()) ? &m_words[_index] : nullptr;
         }
 
         /// @retrns vocabulary size
@@ -93,6 +195,11 @@ namespace w2v {
             return m_totalWords;
         }
 
+        /// @returns amount of words pruned from the vocabulary while counting (see maxDistinctWords)
+        inline std::size_t prunedWords() const noexcept  {
+            return m_prunedWords;
+        }
+
         /// @returns train words amount (totalWords - amount(stop words) - amount(words with low frequency))
         inline std::size_t trainWords() const noexcept  {
             return m_trainWords;
@@ -105,8 +212,8 @@ namespace w2v {
         */
         inline void frequencies(std::vector<std::size_t> &_output) const noexcept {
             _output.resize(m_words.size());
-            for (auto const &i:m_words) {
-                _output[i.second.index] = i.second.frequency;
+            for (std::size_t i = 0; i < m_words.size(); ++i) {
+                _output[i] = m_words[i].frequency;
             }
         }
 
@@ -116,16 +223,8 @@ namespace w2v {
         */
         inline void words(std::vector<std::string> &_words) const noexcept {
             _words.clear();
-            std::vector<std::pair<std::size_t, std::string>> indexedWords;
-            for (auto const &i:m_words) {
-                indexedWords.emplace_back(std::pair<std::size_t, std::string>(i.second.index, i.first));
-            }
-            std::sort(indexedWords.begin(), indexedWords.end(), [](const std::pair<std::size_t, std::string> &_what,
-                                                                   const std::pair<std::size_t, std::string> &_with) {
-                return _what.first < _with.first;
-            });
-            for (auto const &i:indexedWords) {
-                _words.push_back(i.second);
+            for (std::size_t i = 0; i < m_words.size(); ++i) {
+                _words.emplace_back(m_arena.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
             }
         }
     };
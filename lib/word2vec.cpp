@@ -11,18 +11,37 @@
 #include "word2vec.hpp"
 #include "wordReader.hpp"
 #include "vocabulary.hpp"
+#include "trainMatrix.hpp"
 #include "trainer.hpp"
+#include "checkpoint.hpp"
 
 namespace w2v {
+    void w2vModel_t::assign(std::vector<std::string> &_words, trainMatrix_t &_trainMatrix,
+                            const trainSettings_t &_trainSettings) {
+        // map nodes are created first, then vectors are filled by several threads without touching the map itself
+        std::vector<vector_t *> vectors(_words.size());
+        m_map.reserve(_words.size());
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            vectors[i] = &m_map[std::move(_words[i])];
+        }
+        std::vector<std::string>().swap(_words);
+
+        const auto vectorSize = m_vectorSize;
+        _trainMatrix.release([&vectors, vectorSize](std::size_t _row, const float *_values) {
+            vectors[_row]->assign(_values, _values + vectorSize);
+        }, _trainSettings.cpuAffinity, _trainSettings.threads);
+    }
+
     bool w2vModel_t::train(const trainSettings_t &_trainSettings,
-                           const std::string &_trainFile,
+                           const std::vector<std::string> &_trainFiles,
                            const std::string &_stopWordsFile,
                            vocabularyProgressCallback_t _vocabularyProgressCallback,
                            vocabularyStatsCallback_t _vocabularyStatsCallback,
-                           trainProgressCallback_t _trainProgressCallback) noexcept {
+                           trainProgressCallback_t _trainProgressCallback,
+                           numaStatsCallback_t _numaStatsCallback) noexcept {
         try {
-            // map train data set file to memory
-            std::shared_ptr<fileMapper_t> trainWordsMapper(new fileMapper_t(_trainFile));
+            // map train data set files to memory
+            std::shared_ptr<corpus_t> corpus(new corpus_t(_trainFiles));
             // map stop-words file to memory
             std::shared_ptr<fileMapper_t> stopWordsMapper;
             if (!_stopWordsFile.empty()) {
@@ -30,35 +49,161 @@ namespace w2v {
             }
 
             // build vocabulary, skip stop-words and words with frequency < minWordFreq
-            std::shared_ptr<vocabulary_t> vocabulary(new vocabulary_t(trainWordsMapper,
+            std::shared_ptr<vocabulary_t> vocabulary(new vocabulary_t(corpus,
                                                                       stopWordsMapper,
                                                                       _trainSettings.wordDelimiterChars,
                                                                       _trainSettings.endOfSentenceChars,
                                                                       _trainSettings.minWordFreq,
-                                                                      _vocabularyProgressCallback,
-                                                                      _vocabularyStatsCallback));
+                                                                      _trainSettings.threads,
+                                                                      _trainSettings.decompressionThreads,
+                                                                      _trainSettings.maxDistinctWords,
+                                                                      _vocabularyProgressCallback));
+            m_prunedWords = vocabulary->prunedWords();
+            if (_vocabularyStatsCallback != nullptr) {
+                _vocabularyStatsCallback(vocabulary->size(), vocabulary->trainWords(), vocabulary->totalWords());
+            }
+            m_vectorSize = _trainSettings.size;
+            m_mapSize = vocabulary->size();
+
+            // train model
+            std::unique_ptr<trainMatrix_t> trainMatrix;
+            trainer_t(std::make_shared<trainSettings_t>(_trainSettings),
+                      vocabulary,
+                      corpus,
+                      _trainProgressCallback,
+                      _numaStatsCallback)(trainMatrix);
+            corpus.reset();
+
             // key words descending ordered by their indexes
             std::vector<std::string> words;
             vocabulary->words(words);
-            m_vectorSize = _trainSettings.size;
+            vocabulary.reset();
+            assign(words, *trainMatrix, _trainSettings);
+
+            return true;
+        } catch (const std::exception &_e) {
+            m_errMsg = _e.what();
+        } catch (...) {
+            m_errMsg = "unknown error";
+        }
+
+        return false;
+    }
+
+    bool w2vModel_t::resume(const trainSettings_t &_trainSettings,
+                            const std::vector<std::string> &_trainFiles,
+                            const std::string &_checkpointFile,
+                            trainProgressCallback_t _trainProgressCallback,
+                            numaStatsCallback_t _numaStatsCallback) noexcept {
+        try {
+            // model parameters are restored from the checkpoint, runtime ones are taken from _trainSettings
+            std::shared_ptr<trainSettings_t> trainSettings(new trainSettings_t(_trainSettings));
+            std::shared_ptr<checkpoint_t> checkpoint(new checkpoint_t());
+            checkpoint->load(_checkpointFile, *trainSettings);
+
+            std::shared_ptr<corpus_t> corpus(new corpus_t(_trainFiles));
+            std::shared_ptr<vocabulary_t> vocabulary(new vocabulary_t(checkpoint->words,
+                                                                      checkpoint->trainWords,
+                                                                      checkpoint->totalWords,
+                                                                      checkpoint->prunedWords));
+            m_prunedWords = vocabulary->prunedWords();
+            m_vectorSize = trainSettings->size;
             m_mapSize = vocabulary->size();
 
             // train model
-            std::vector<float> _trainMatrix;
-            trainer_t(std::make_shared<trainSettings_t>(_trainSettings),
+            std::unique_ptr<trainMatrix_t> trainMatrix;
+            trainer_t(trainSettings,
                       vocabulary,
-                      trainWordsMapper,
-                      _trainProgressCallback)(_trainMatrix);
+                      corpus,
+                      _trainProgressCallback,
+                      _numaStatsCallback,
+                      checkpoint)(trainMatrix);
+            corpus.reset();
+            checkpoint.reset();
 
-            std::size_t wordIndex = 0;
-            for (auto const &i:words) {
-                auto &v = m_map[i];
-                v.resize(m_vectorSize);
-                std::copy(&_trainMatrix[wordIndex * m_vectorSize],
-                          &_trainMatrix[(wordIndex + 1) * m_vectorSize],
-                          &v[0]);
-                wordIndex++;
+            std::vector<std::string> words;
+            vocabulary->words(words);
+            vocabulary.reset();
+            assign(words, *trainMatrix, *trainSettings);
+
+            return true;
+        } catch (const std::exception &_e) {
+            m_errMsg = _e.what();
+        } catch (...) {
+            m_errMsg = "unknown error";
+        }
+
+        return false;
+    }
+
+    bool w2vModel_t::update(const trainSettings_t &_trainSettings,
+                            const std::vector<std::string> &_trainFiles,
+                            const std::string &_stopWordsFile,
+                            const std::string &_baseFile,
+                            vocabularyProgressCallback_t _vocabularyProgressCallback,
+                            vocabularyStatsCallback_t _vocabularyStatsCallback,
+                            trainProgressCallback_t _trainProgressCallback,
+                            numaStatsCallback_t _numaStatsCallback) noexcept {
+        try {
+            std::shared_ptr<trainSettings_t> trainSettings(new trainSettings_t(_trainSettings));
+            std::shared_ptr<checkpoint_t> baseModel(new checkpoint_t());
+            trainSettings_t baseSettings = _trainSettings;
+            baseModel->load(_baseFile, baseSettings);
+            // matrices of the trained model define the vector size, the storage format and the meaning of output rows
+            trainSettings->size = baseSettings.size;
+            trainSettings->precision = baseSettings.precision;
+            trainSettings->withHS = baseSettings.withHS;
+
+            // map train data set files to memory
+            std::shared_ptr<corpus_t> corpus(new corpus_t(_trainFiles));
+            // map stop-words file to memory
+            std::shared_ptr<fileMapper_t> stopWordsMapper;
+            if (!_stopWordsFile.empty()) {
+                stopWordsMapper.reset(new fileMapper_t(_stopWordsFile));
+            }
+
+            std::shared_ptr<vocabulary_t> vocabulary;
+            {
+                // all words of the new data are counted, words of the model are trained whatever their new
+                // frequencies are
+                vocabulary_t newWords(corpus,
+                                      stopWordsMapper,
+                                      trainSettings->wordDelimiterChars,
+                                      trainSettings->endOfSentenceChars,
+                                      1,
+                                      trainSettings->threads,
+                                      trainSettings->decompressionThreads,
+                                      trainSettings->maxDistinctWords,
+                                      _vocabularyProgressCallback);
+                vocabulary.reset(new vocabulary_t(baseModel->words, newWords, trainSettings->minWordFreq));
+                std::vector<std::pair<std::string, std::size_t>>().swap(baseModel->words);
+            }
+            m_prunedWords = vocabulary->prunedWords();
+            if (_vocabularyStatsCallback != nullptr) {
+                _vocabularyStatsCallback(vocabulary->size(), vocabulary->trainWords(), vocabulary->totalWords());
             }
+            m_vectorSize = trainSettings->size;
+            m_mapSize = vocabulary->size();
+
+            // train model, the trainer releases matrices of the trained model once they are copied
+            std::unique_ptr<trainMatrix_t> trainMatrix;
+            {
+                trainer_t trainer(trainSettings,
+                                  vocabulary,
+                                  corpus,
+                                  _trainProgressCallback,
+                                  _numaStatsCallback,
+                                  nullptr,
+                                  baseModel);
+                baseModel.reset();
+                trainer(trainMatrix);
+            }
+            corpus.reset();
+
+            std::vector<std::string> words;
+            vocabulary->words(words);
+            vocabulary.reset();
+            assign(words, *trainMatrix, *trainSettings);
 
             return true;
         } catch (const std::exception &_e) {
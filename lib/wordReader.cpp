@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief delimiterScanner class - SIMD implementations of the delimiter chars search with runtime dispatching
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include "wordReader.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define W2V_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace w2v {
+    struct delimiterScannerImpl_t final {
+        static const char *findGeneric(const delimiterScanner_t &_scanner, const char *_from, const char *_to) {
+            while ((_from < _to) && (_scanner.m_classes[static_cast<uint8_t>(*_from)] == 0)) {
+                ++_from;
+            }
+            return _from;
+        }
+
+#ifdef W2V_X86_DISPATCH
+        // A char c is a delimiter if bit (c >> 4) is set in the bitmap row (c & 0x0f). Rows are looked up by the low
+        // nibbles and bits are looked up by the high nibbles, both with byte shuffles.
+        __attribute__((target("ssse3")))
+        static const char *findSSSE3(const delimiterScanner_t &_scanner, const char *_from, const char *_to) {
+            const __m128i lowBitmap = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_scanner.m_lowBitmap));
+            const __m128i highBitmap = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_scanner.m_highBitmap));
+            const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+            const __m128i seven = _mm_set1_epi8(7);
+            for (; _from + 16 <= _to; _from += 16) {
+                __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_from));
+                __m128i low = _mm_and_si128(chars, nibbleMask);
+                __m128i high = _mm_and_si128(_mm_srli_epi16(chars, 4), nibbleMask);
+                __m128i isHigh = _mm_cmpgt_epi8(high, seven);
+                __m128i rows = _mm_or_si128(_mm_andnot_si128(isHigh, _mm_shuffle_epi8(lowBitmap, low)),
+                                            _mm_and_si128(isHigh, _mm_shuffle_epi8(highBitmap, low)));
+                __m128i found = _mm_and_si128(rows, _mm_shuffle_epi8(bits, high));
+                auto mask = static_cast<unsigned int>(
+                        _mm_movemask_epi8(_mm_cmpeq_epi8(found, _mm_setzero_si128()))) ^ 0xffffU;
+                if (mask != 0) {
+                    return _from + __builtin_ctz(mask);
+                }
+            }
+            return findGeneric(_scanner, _from, _to);
+        }
+
+        __attribute__((target("avx2")))
+        static const char *findAVX2(const delimiterScanner_t &_scanner, const char *_from, const char *_to) {
+            const __m256i lowBitmap = _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(_scanner.m_lowBitmap)));
+            const __m256i highBitmap = _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(_scanner.m_highBitmap)));
+            const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                                  1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            const __m256i nibbleMask = _mm256_set1_epi8(0x0f);
+            const __m256i seven = _mm256_set1_epi8(7);
+            for (; _from + 32 <= _to; _from += 32) {
+                __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_from));
+                __m256i low = _mm256_and_si256(chars, nibbleMask);
+                __m256i high = _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibbleMask);
+                __m256i rows = _mm256_blendv_epi8(_mm256_shuffle_epi8(lowBitmap, low),
+                                                  _mm256_shuffle_epi8(highBitmap, low),
+                                                  _mm256_cmpgt_epi8(high, seven));
+                __m256i found = _mm256_and_si256(rows, _mm256_shuffle_epi8(bits, high));
+                auto mask = ~static_cast<unsigned int>(
+                        _mm256_movemask_epi8(_mm256_cmpeq_epi8(found, _mm256_setzero_si256())));
+                if (mask != 0) {
+                    return _from + __builtin_ctz(mask);
+                }
+            }
+            return findSSSE3(_scanner, _from, _to);
+        }
+#endif
+
+        static delimiterScanner_t::findImpl_t select() noexcept {
+#ifdef W2V_X86_DISPATCH
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return findAVX2;
+            }
+            if (__builtin_cpu_supports("ssse3")) {
+                return findSSSE3;
+            }
+#endif
+            return findGeneric;
+        }
+    };
+
+    const char *delimiterScanner_t::find(const char *_from, const char *_to) const noexcept {
+        static const findImpl_t impl = delimiterScannerImpl_t::select();
+        return impl(*this, _from, _to);
+    }
+
+    std::vector<delimiterScanner_t::findImpl_t> delimiterScanner_t::implementations() {
+        std::vector<findImpl_t> ret = {delimiterScannerImpl_t::findGeneric};
+#ifdef W2V_X86_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("ssse3")) {
+            ret.push_back(delimiterScannerImpl_t::findSSSE3);
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            ret.push_back(delimiterScannerImpl_t::findAVX2);
+        }
+#endif
+        return ret;
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief checkpoint test - saved training state is loaded bit-identical, resumed learning rate
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "checkpoint.hpp"
+#include "trainThread.hpp"
+#include "test.hpp"
+
+namespace {
+    // floats are compared by their bits, a loaded value must be exactly the saved one
+    bool sameBits(float _a, float _b) {
+        return std::memcmp(&_a, &_b, sizeof(float)) == 0;
+    }
+
+    void testRoundTrip() {
+        const auto checkpointFile = w2v::test::tmpFile("checkpoint.bin");
+        std::mt19937_64 randomGenerator(17);
+        for (auto precision:{w2v::matrixPrecision_t::FP32, w2v::matrixPrecision_t::BF16,
+                             w2v::matrixPrecision_t::FP16}) {
+            w2v::trainSettings_t settings;
+            settings.minWordFreq = 3;
+            settings.maxDistinctWords = 123456789;
+            settings.size = 7;
+            settings.window = 9;
+            settings.expTableSize = 2000;
+            settings.expValueMax = 8;
+            settings.sample = 1.2345e-4f;
+            settings.withHS = true;
+            settings.negative = 11;
+            settings.iterations = 13;
+            settings.alpha = 0.0271828f;
+            settings.withSG = true;
+            settings.withBatchedSG = true;
+            settings.precision = precision;
+            settings.corpusCacheFile = "corpus.cache";
+            settings.wordDelimiterChars = " \n\t\x80\xff";
+            settings.endOfSentenceChars = ".\n";
+
+            w2v::checkpoint_t saved;
+            saved.seed = 0xfedcba9876543210ULL;
+            saved.trainDataSize = 0x123456789aULL;
+            saved.trainDataFiles = 3;
+            saved.chunks = 40;
+            saved.position = 77;
+            saved.processedWords = 0xabcdef012345ULL;
+            saved.trainWords = 1000;
+            saved.totalWords = 1100;
+            saved.prunedWords = 50;
+            saved.words = {{"</s>", 10}, {"the", 500}, {"", 1}, {std::string("a\0b", 3), 0x1234567890ULL}};
+            for (std::size_t i = 0; i < 100; ++i) {
+                saved.words.emplace_back("word" + std::to_string(i), 100 - i);
+            }
+            const std::size_t elementSize = (precision == w2v::matrixPrecision_t::FP32) ? 4 : 2;
+            const std::size_t matrixBytes = saved.words.size() * settings.size * elementSize;
+            for (auto matrix:{&saved.trainMatrix, &saved.bpWeights}) {
+                matrix->resize(matrixBytes);
+                for (auto &i:*matrix) {
+                    i = static_cast<uint8_t>(randomGenerator());
+                }
+            }
+            saved.save(checkpointFile, settings);
+
+            // model parameters are restored, runtime parameters of the resumed training are kept
+            w2v::trainSettings_t loadedSettings;
+            loadedSettings.threads = 3;
+            loadedSettings.hotRows = 5;
+            w2v::checkpoint_t loaded;
+            loaded.load(checkpointFile, loadedSettings);
+
+            W2V_CHECK(loadedSettings.minWordFreq == settings.minWordFreq);
+            W2V_CHECK(loadedSettings.maxDistinctWords == settings.maxDistinctWords);
+            W2V_CHECK(loadedSettings.size == settings.size);
+            W2V_CHECK(loadedSettings.window == settings.window);
+            W2V_CHECK(loadedSettings.expTableSize == settings.expTableSize);
+            W2V_CHECK(loadedSettings.expValueMax == settings.expValueMax);
+            W2V_CHECK(sameBits(loadedSettings.sample, settings.sample));
+            W2V_CHECK(loadedSettings.withHS == settings.withHS);
+            W2V_CHECK(loadedSettings.negative == settings.negative);
+            W2V_CHECK(loadedSettings.iterations == settings.iterations);
+            W2V_CHECK(sameBits(loadedSettings.alpha, settings.alpha));
+            W2V_CHECK(loadedSettings.withSG == settings.withSG);
+            W2V_CHECK(loadedSettings.withBatchedSG == settings.withBatchedSG);
+            W2V_CHECK(loadedSettings.precision == settings.precision);
+            W2V_CHECK(loadedSettings.corpusCacheFile == settings.corpusCacheFile);
+            W2V_CHECK(loadedSettings.wordDelimiterChars == settings.wordDelimiterChars);
+            W2V_CHECK(loadedSettings.endOfSentenceChars == settings.endOfSentenceChars);
+            W2V_CHECK(loadedSettings.threads == 3);
+            W2V_CHECK(loadedSettings.hotRows == 5);
+
+            W2V_CHECK(loaded.seed == saved.seed);
+            W2V_CHECK(loaded.trainDataSize == saved.trainDataSize);
+            W2V_CHECK(loaded.trainDataFiles == saved.trainDataFiles);
+            W2V_CHECK(loaded.chunks == saved.chunks);
+            W2V_CHECK(loaded.position == saved.position);
+            W2V_CHECK(loaded.processedWords == saved.processedWords);
+            W2V_CHECK(loaded.trainWords == saved.trainWords);
+            W2V_CHECK(loaded.totalWords == saved.totalWords);
+            W2V_CHECK(loaded.prunedWords == saved.prunedWords);
+            W2V_CHECK(loaded.words == saved.words);
+            W2V_CHECK(loaded.trainMatrix == saved.trainMatrix);
+            W2V_CHECK(loaded.bpWeights == saved.bpWeights);
+        }
+
+        // a truncated checkpoint is rejected and the settings are not changed
+        {
+            std::FILE *file = std::fopen(checkpointFile.c_str(), "r+b");
+            W2V_CHECK(file != nullptr);
+            if (file != nullptr) {
+                std::fseek(file, 0, SEEK_END);
+                const long size = std::ftell(file);
+                std::fclose(file);
+                W2V_CHECK(truncate(checkpointFile.c_str(), size - 1) == 0);
+            }
+            w2v::trainSettings_t settings;
+            w2v::checkpoint_t loaded;
+            bool failed = false;
+            try {
+                loaded.load(checkpointFile, settings);
+            } catch (const std::runtime_error &) {
+                failed = true;
+            }
+            W2V_CHECK(failed);
+            W2V_CHECK(settings.size == w2v::trainSettings_t().size);
+        }
+
+        std::remove(checkpointFile.c_str());
+    }
+
+    void testResumedAlpha() {
+        std::shared_ptr<w2v::trainSettings_t> settings(new w2v::trainSettings_t());
+        settings->iterations = 4;
+        settings->alpha = 0.04f;
+        settings->threads = 2;
+
+        std::vector<std::pair<std::string, std::size_t>> words = {{"</s>", 100}, {"a", 600}, {"b", 300}};
+        w2v::trainThread_t::sharedData_t sharedData;
+        sharedData.trainSettings = settings;
+        sharedData.vocabulary.reset(new w2v::vocabulary_t(words, 1000, 1000, 0));
+        sharedData.processedWords.reset(new std::vector<w2v::trainThread_t::wordsCounter_t>(settings->threads));
+
+        // a new training starts with the starting learning rate
+        W2V_CHECK(w2v::trainThread_t::alpha(sharedData) == settings->alpha);
+
+        // words processed before the training was resumed decay the learning rate as if the training went on,
+        // 4 iterations of 1000 train words, 1000 words processed before the checkpoint and 1000 words after it
+        sharedData.resumedWords = 1000;
+        W2V_CHECK_NEAR(w2v::trainThread_t::alpha(sharedData), settings->alpha * 0.75f, 1e-7f);
+        (*sharedData.processedWords)[0].value.store(600);
+        (*sharedData.processedWords)[1].value.store(400);
+        W2V_CHECK_NEAR(w2v::trainThread_t::alpha(sharedData), settings->alpha * 0.5f, 1e-7f);
+
+        // the learning rate never falls below 0.01% of the starting one
+        sharedData.resumedWords = 4000;
+        W2V_CHECK_NEAR(w2v::trainThread_t::alpha(sharedData), settings->alpha * 0.0001f, 1e-9f);
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testResumedAlpha();
+
+    return w2v::test::result();
+}
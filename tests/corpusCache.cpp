@@ -0,0 +1,146 @@
+/**
+ * @file
+ * @brief corpus cache test - varint coding, cache content, reuse and rebuild of the cache file
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+#include "vocabulary.hpp"
+#include "corpusCache.hpp"
+#include "test.hpp"
+
+namespace {
+    void testVarint() {
+        std::vector<uint32_t> values;
+        for (uint32_t i = 0; i < (1U << 16U); ++i) {
+            values.push_back(i);
+        }
+        // every length of the encoded value and its bounds
+        for (unsigned int shift = 7; shift < 32; shift += 7) {
+            values.push_back((1U << shift) - 1);
+            values.push_back(1U << shift);
+            values.push_back((1U << shift) + 1);
+        }
+        values.push_back(UINT32_MAX - 1);
+        values.push_back(UINT32_MAX);
+
+        std::vector<uint8_t> buffer;
+        for (auto i:values) {
+            auto size = buffer.size();
+            w2v::corpusCache_t::put(i, buffer);
+            // LEB128 size, and a non-zero value never contains 0 byte, so 0 is always the end of a sentence
+            std::size_t expectedSize = 1;
+            for (auto v = i; v >= 0x80U; v >>= 7U) {
+                ++expectedSize;
+            }
+            W2V_CHECK(buffer.size() - size == expectedSize);
+            for (auto j = size; (i > 0) && (j < buffer.size()); ++j) {
+                W2V_CHECK(buffer[j] != 0);
+            }
+        }
+        const uint8_t *pos = buffer.data();
+        for (auto i:values) {
+            W2V_CHECK(w2v::corpusCache_t::next(pos) == i);
+        }
+        W2V_CHECK(pos == buffer.data() + buffer.size());
+    }
+
+    // decodes the cache stream to sentences of words
+    std::vector<std::string> decode(const w2v::corpusCache_t &_cache, const w2v::vocabulary_t &_vocabulary) {
+        std::vector<std::string> words;
+        _vocabulary.words(words);
+        std::vector<std::string> ret(1);
+        const uint8_t *pos = _cache.data();
+        while (pos < _cache.data() + _cache.size()) {
+            auto value = w2v::corpusCache_t::next(pos);
+            if (value == 0) {
+                ret.emplace_back();
+            } else {
+                ret.back() += (ret.back().empty() ? "" : " ") + words[value - 1];
+            }
+        }
+        ret.pop_back();
+        return ret;
+    }
+
+    void testCacheFile() {
+        const auto corpusFile = w2v::test::tmpFile("corpusCache.txt");
+        const auto cacheFile = w2v::test::tmpFile("corpusCache.bin");
+        std::remove(cacheFile.c_str());
+        {
+            std::ofstream corpus(corpusFile, std::ios::trunc);
+            for (int i = 0; i < 100; ++i) {
+                corpus << "the cat sat on the mat. the dog sat on a log!\n\n";
+            }
+        }
+
+        w2v::trainSettings_t trainSettings;
+        trainSettings.minWordFreq = 1;
+        trainSettings.threads = 3;
+        std::shared_ptr<w2v::corpus_t> corpus(new w2v::corpus_t({corpusFile}));
+        const w2v::vocabulary_t vocabulary(corpus, nullptr,
+                                           trainSettings.wordDelimiterChars, trainSettings.endOfSentenceChars,
+                                           trainSettings.minWordFreq, trainSettings.threads,
+                                           trainSettings.decompressionThreads, trainSettings.maxDistinctWords,
+                                           nullptr);
+
+        std::vector<std::string> sentences;
+        {
+            const w2v::corpusCache_t cache(cacheFile, *corpus, vocabulary, trainSettings);
+            W2V_CHECK(!cache.reused());
+            sentences = decode(cache, vocabulary);
+            W2V_CHECK(sentences.size() == 200);
+            for (std::size_t i = 0; i < sentences.size(); ++i) {
+                W2V_CHECK(sentences[i] == ((i % 2 == 0) ? "the cat sat on the mat" : "the dog sat on a log"));
+            }
+        }
+        {
+            const w2v::corpusCache_t cache(cacheFile, *corpus, vocabulary, trainSettings);
+            W2V_CHECK(cache.reused());
+            W2V_CHECK(decode(cache, vocabulary) == sentences);
+        }
+
+        // a hash mismatch in the header, the cache is rebuilt
+        {
+            std::fstream cache(cacheFile, std::ios::in | std::ios::out | std::ios::binary);
+            const std::size_t hashOffset = 16; // after the magic, the version and the reserved fields
+            cache.seekg(hashOffset);
+            char ch = 0;
+            cache.read(&ch, 1);
+            ch ^= 1;
+            cache.seekp(hashOffset);
+            cache.write(&ch, 1);
+        }
+        {
+            const w2v::corpusCache_t cache(cacheFile, *corpus, vocabulary, trainSettings);
+            W2V_CHECK(!cache.reused());
+            W2V_CHECK(decode(cache, vocabulary) == sentences);
+        }
+
+        // other word delimiters change the hash, the cache is rebuilt
+        {
+            auto otherSettings = trainSettings;
+            otherSettings.wordDelimiterChars += "x";
+            const w2v::corpusCache_t cache(cacheFile, *corpus, vocabulary, otherSettings);
+            W2V_CHECK(!cache.reused());
+        }
+
+        std::remove(cacheFile.c_str());
+        std::remove(corpusFile.c_str());
+    }
+}
+
+int main() {
+    testVarint();
+    testCacheFile();
+
+    return w2v::test::result();
+}
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief gzipReader test - multi-member files are decoded in parallel to the same text and words as plain text
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef W2V_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "corpus.hpp"
+#include "gzipReader.hpp"
+#include "vocabulary.hpp"
+#include "test.hpp"
+
+#ifdef W2V_WITH_ZLIB
+namespace {
+    const std::string wordDelimiterChars = " \n";
+    const std::string endOfSentenceChars = "\n";
+
+    // compresses _text to one gzip member
+    std::string gzip(const std::string &_text) {
+        z_stream stream{};
+        W2V_CHECK(deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+        std::string ret(deflateBound(&stream, static_cast<uLong>(_text.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(_text.data()));
+        stream.avail_in = static_cast<uInt>(_text.size());
+        stream.next_out = reinterpret_cast<Bytef *>(&ret[0]);
+        stream.avail_out = static_cast<uInt>(ret.size());
+        W2V_CHECK(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+        ret.resize(stream.total_out);
+        deflateEnd(&stream);
+        return ret;
+    }
+
+    // compresses _text to independent members of about _memberSize text bytes, members are cut inside words too
+    std::string gzipMembers(const std::string &_text, std::size_t _memberSize) {
+        std::string ret;
+        for (std::size_t pos = 0; pos < _text.size(); pos += _memberSize) {
+            ret += gzip(_text.substr(pos, _memberSize));
+        }
+        return ret;
+    }
+
+    void writeFile(const std::string &_fileName, const std::string &_data) {
+        std::ofstream file(_fileName, std::ios::binary | std::ios::trunc);
+        file.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+    }
+
+    // takes all blocks by _consumers threads and joins them in the order they are dealt to the threads
+    std::string readAll(const w2v::corpus_t &_corpus, std::size_t _consumers, std::size_t _rangeSize) {
+        const w2v::delimiterScanner_t scanner(wordDelimiterChars, endOfSentenceChars);
+        w2v::gzipReader_t gzipReader(_corpus, scanner, 4, _consumers, 2, _rangeSize);
+        std::vector<std::vector<std::string>> blocks(_consumers);
+        std::vector<std::thread> threads;
+        for (std::size_t c = 0; c < _consumers; ++c) {
+            threads.emplace_back([&gzipReader, &blocks, c]() {
+                std::string block;
+                while (gzipReader.next(c, block)) {
+                    blocks[c].push_back(block);
+                }
+            });
+        }
+        for (auto &i:threads) {
+            i.join();
+        }
+
+        // blocks are dealt round-robin, so the threads run out of blocks in turn
+        std::string ret;
+        std::vector<std::size_t> taken(_consumers, 0);
+        for (std::size_t c = 0; taken[c] < blocks[c].size(); c = (c + 1) % _consumers) {
+            W2V_CHECK(!blocks[c][taken[c]].empty());
+            ret += blocks[c][taken[c]++];
+        }
+        for (std::size_t c = 0; c < _consumers; ++c) {
+            W2V_CHECK(taken[c] == blocks[c].size());
+        }
+        return ret;
+    }
+
+    void testMultiMember() {
+        // random sentences of random words
+        std::mt19937 randomGenerator(5);
+        std::string text;
+        while (text.size() < 2 * 1024 * 1024) {
+            const auto words = 1 + randomGenerator() % 20;
+            for (std::size_t i = 0; i < words; ++i) {
+                text += (i > 0) ? " " : "";
+                text += "w" + std::to_string(randomGenerator() % 5000);
+            }
+            text += "\n";
+        }
+        // the last word of the file has no delimiter after it
+        text += "last";
+
+        const auto textFile = w2v::test::tmpFile("gzipReader.txt");
+        const auto singleFile = w2v::test::tmpFile("gzipReader_single.gz");
+        const auto multiFile = w2v::test::tmpFile("gzipReader_multi.gz");
+        writeFile(textFile, text);
+        writeFile(singleFile, gzip(text));
+        writeFile(multiFile, gzipMembers(text, 20000));
+
+        std::shared_ptr<w2v::corpus_t> textCorpus(new w2v::corpus_t({textFile}));
+        std::shared_ptr<w2v::corpus_t> singleCorpus(new w2v::corpus_t({singleFile}));
+        std::shared_ptr<w2v::corpus_t> multiCorpus(new w2v::corpus_t({multiFile}));
+        W2V_CHECK(textCorpus->compressedFiles() == 0);
+        W2V_CHECK(singleCorpus->compressedFiles() == 1);
+        W2V_CHECK(multiCorpus->compressedFiles() == 1);
+
+        // many small ranges, their members are found by search and their words cut by range bounds are joined
+        for (std::size_t consumers = 1; consumers <= 3; ++consumers) {
+            W2V_CHECK(readAll(*singleCorpus, consumers, 64 * 1024) == text);
+            W2V_CHECK(readAll(*multiCorpus, consumers, 64 * 1024) == text);
+            W2V_CHECK(readAll(*multiCorpus, consumers, 7777) == text);
+        }
+
+        // the same words as the plain text has
+        const w2v::vocabulary_t textVocabulary(textCorpus, nullptr, wordDelimiterChars, endOfSentenceChars,
+                                               1, 3, 1, 0, nullptr);
+        const w2v::vocabulary_t multiVocabulary(multiCorpus, nullptr, wordDelimiterChars, endOfSentenceChars,
+                                                1, 3, 4, 0, nullptr);
+        W2V_CHECK(multiVocabulary.totalWords() == textVocabulary.totalWords());
+        W2V_CHECK(multiVocabulary.size() == textVocabulary.size());
+        std::vector<std::string> words;
+        textVocabulary.words(words);
+        for (auto const &i:words) {
+            auto wordData = multiVocabulary.data(i);
+            W2V_CHECK((wordData != nullptr) && (wordData->frequency == textVocabulary.data(i)->frequency));
+        }
+
+        std::remove(textFile.c_str());
+        std::remove(singleFile.c_str());
+        std::remove(multiFile.c_str());
+    }
+}
+#endif
+
+int main() {
+#ifdef W2V_WITH_ZLIB
+    testMultiMember();
+#endif
+
+    return w2v::test::result();
+}
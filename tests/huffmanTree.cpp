@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Huffman tree test - codes and points of a small skewed vocabulary are compared with expected ones
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "huffmanTree.hpp"
+#include "test.hpp"
+
+namespace {
+    std::string codeString(const w2v::huffmanTree_t::huffmanData_t &_data) {
+        std::string ret;
+        for (std::size_t i = 0; i < _data.length; ++i) {
+            ret += _data.code(i) ? '1' : '0';
+        }
+        return ret;
+    }
+
+    std::vector<uint32_t> points(const w2v::huffmanTree_t::huffmanData_t &_data) {
+        return std::vector<uint32_t>(_data.points, _data.points + _data.length);
+    }
+}
+
+int main() {
+    {
+        // vocabulary order: the sentence delimiter is the first and the most frequent, then words from more
+        // frequent to less frequent. Every branch takes a leaf and the previous branch, so the tree is a chain.
+        const std::vector<std::size_t> frequencies = {41, 40, 20, 10, 5, 3, 2};
+        const w2v::huffmanTree_t tree(frequencies);
+        const std::vector<std::string> codes = {"0", "10", "110", "1110", "11110", "111111", "111110"};
+        const std::vector<std::vector<uint32_t>> expectedPoints = {
+                {5},
+                {5, 4},
+                {5, 4, 3},
+                {5, 4, 3, 2},
+                {5, 4, 3, 2, 1},
+                {5, 4, 3, 2, 1, 0},
+                {5, 4, 3, 2, 1, 0}
+        };
+        for (std::size_t i = 0; i < frequencies.size(); ++i) {
+            const auto data = tree.huffmanData(i);
+            W2V_CHECK(codeString(data) == codes[i]);
+            W2V_CHECK(points(data) == expectedPoints[i]);
+        }
+        W2V_CHECK(tree.huffmanData(frequencies.size()).length == 0);
+    }
+
+    {
+        // equal frequencies give a balanced tree
+        const std::vector<std::size_t> frequencies = {5, 5, 5, 5};
+        const w2v::huffmanTree_t tree(frequencies);
+        const std::vector<std::string> codes = {"11", "10", "01", "00"};
+        const std::vector<std::vector<uint32_t>> expectedPoints = {{2, 1}, {2, 1}, {2, 0}, {2, 0}};
+        for (std::size_t i = 0; i < frequencies.size(); ++i) {
+            const auto data = tree.huffmanData(i);
+            W2V_CHECK(codeString(data) == codes[i]);
+            W2V_CHECK(points(data) == expectedPoints[i]);
+        }
+    }
+
+    {
+        // a random vocabulary - codes have the optimal total length and none of them is a prefix of another one
+        std::mt19937 randomGenerator(5);
+        std::vector<std::size_t> frequencies(1000);
+        for (auto &i:frequencies) {
+            i = 1 + randomGenerator() % 100000;
+        }
+        std::sort(frequencies.begin() + 1, frequencies.end(), std::greater<std::size_t>());
+        frequencies[0] = frequencies[1] + 1;
+        const w2v::huffmanTree_t tree(frequencies);
+
+        std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>>
+                queue(frequencies.begin(), frequencies.end());
+        std::size_t optimalLength = 0;
+        while (queue.size() > 1) {
+            auto first = queue.top();
+            queue.pop();
+            auto second = queue.top();
+            queue.pop();
+            optimalLength += first + second;
+            queue.push(first + second);
+        }
+
+        std::size_t length = 0;
+        std::vector<std::string> codes;
+        for (std::size_t i = 0; i < frequencies.size(); ++i) {
+            const auto data = tree.huffmanData(i);
+            length += frequencies[i] * data.length;
+            codes.push_back(codeString(data));
+            for (std::size_t j = 0; j < data.length; ++j) {
+                W2V_CHECK(data.points[j] < frequencies.size() - 1);
+            }
+        }
+        W2V_CHECK(length == optimalLength);
+        std::sort(codes.begin(), codes.end());
+        for (std::size_t i = 1; i < codes.size(); ++i) {
+            W2V_CHECK(codes[i].compare(0, codes[i - 1].size(), codes[i - 1]) != 0);
+        }
+    }
+
+    return w2v::test::result();
+}
@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @brief negative sampling distribution test - empirical distribution of the alias table is unigram^0.75
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "nsDistribution.hpp"
+#include "test.hpp"
+
+namespace {
+    // checks frequencies of the drawn word indexes against unigram^0.75 probabilities
+    void checkDistribution(const std::vector<std::size_t> &_frequencies, const std::vector<std::size_t> &_counts,
+                           std::size_t _samples) {
+        W2V_CHECK(_counts[0] == 0); // the sentence delimiter is never drawn
+
+        double sum = 0.0;
+        for (std::size_t i = 1; i < _frequencies.size(); ++i) {
+            sum += std::pow(static_cast<double>(_frequencies[i]), 0.75);
+        }
+        double chiSquare = 0.0;
+        for (std::size_t i = 1; i < _frequencies.size(); ++i) {
+            const double probability = std::pow(static_cast<double>(_frequencies[i]), 0.75) / sum;
+            const double expected = probability * static_cast<double>(_samples);
+            // 6 standard deviations of the binomial distribution
+            const double tolerance = 6.0 * std::sqrt(expected * (1.0 - probability));
+            W2V_CHECK_NEAR(static_cast<double>(_counts[i]), expected, tolerance);
+            chiSquare += (static_cast<double>(_counts[i]) - expected) * (static_cast<double>(_counts[i]) - expected)
+                         / expected;
+        }
+        // the critical value of chi-square with 9 degrees of freedom (10 words) at p = 0.001 is 27.88
+        W2V_CHECK(chiSquare < 27.88);
+    }
+}
+
+int main() {
+    // a skewed vocabulary of 10 words, index 0 is the sentence delimiter
+    const std::vector<std::size_t> frequencies = {100001, 100000, 30000, 10000, 5000, 1000, 400, 100, 20, 5, 1};
+    const w2v::nsDistribution_t distribution(frequencies);
+    const std::size_t samples = 10000000;
+
+    {
+        w2v::randomGenerator_t randomGenerator(1);
+        std::vector<std::size_t> counts(frequencies.size(), 0);
+        for (std::size_t i = 0; i < samples; ++i) {
+            auto index = distribution(randomGenerator);
+            W2V_CHECK(index < frequencies.size());
+            if (index < frequencies.size()) {
+                ++counts[index];
+            }
+        }
+        checkDistribution(frequencies, counts, samples);
+    }
+
+    {
+        // bulk drawing, the number of values is not a multiple of the internal chunk size
+        w2v::randomGenerator_t randomGenerator(2);
+        std::vector<std::size_t> counts(frequencies.size(), 0);
+        std::vector<std::size_t> output(1001);
+        std::size_t drawn = 0;
+        while (drawn + output.size() <= samples) {
+            distribution.draw(output.size(), output.data(), randomGenerator);
+            for (auto index:output) {
+                W2V_CHECK(index < frequencies.size());
+                if (index < frequencies.size()) {
+                    ++counts[index];
+                }
+            }
+            drawn += output.size();
+        }
+        checkDistribution(frequencies, counts, drawn);
+    }
+
+    {
+        // one word only
+        const w2v::nsDistribution_t single({2, 1});
+        w2v::randomGenerator_t randomGenerator(3);
+        for (std::size_t i = 0; i < 1000; ++i) {
+            W2V_CHECK(single(randomGenerator) == 1);
+        }
+    }
+
+    return w2v::test::result();
+}
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @brief minimal unit test helpers - failed checks are reported and counted, a test exits with non-zero code then
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#ifndef WORD2VEC_TEST_H
+#define WORD2VEC_TEST_H
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace w2v {
+    namespace test {
+        /// @returns reference to the failed checks counter
+        inline std::size_t &failures() noexcept {
+            static std::size_t failures = 0;
+            return failures;
+        }
+
+        /// counts and reports a failed check
+        inline bool check(bool _passed, const char *_expression, const char *_file, int _line) {
+            if (!_passed) {
+                ++failures();
+                std::cerr << _file << ":" << _line << ": check failed: " << _expression << std::endl;
+            }
+            return _passed;
+        }
+
+        /// @returns test exit code
+        inline int result() {
+            if (failures() > 0) {
+                std::cerr << failures() << " check(s) failed" << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+
+        /// @returns name of a temporary file in the current directory, the test runs in its build directory
+        inline std::string tmpFile(const std::string &_name) {
+            return std::string("w2v_test_") + _name;
+        }
+    }
+}
+
+/// checks a condition, a test continues after a failed check
+#define W2V_CHECK(expression_) w2v::test::check((expression_), #expression_, __FILE__, __LINE__)
+/// checks absolute difference of two floating point values
+#define W2V_CHECK_NEAR(value_, expected_, tolerance_) \
+    w2v::test::check(std::fabs(static_cast<double>(value_) - static_cast<double>(expected_)) <= (tolerance_), \
+                     #value_ " ~ " #expected_, __FILE__, __LINE__)
+
+#endif // WORD2VEC_TEST_H
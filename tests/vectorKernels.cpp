@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @brief vector kernels test - every kernels set supported by CPU is compared with the generic one
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "vectorKernels.hpp"
+#include "test.hpp"
+
+namespace {
+    std::mt19937 randomGenerator(17);
+
+    std::vector<float> randomVector(std::size_t _size) {
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        std::vector<float> ret(_size);
+        for (auto &i:ret) {
+            i = distribution(randomGenerator);
+        }
+        return ret;
+    }
+
+    // sums are computed in different orders, so the tolerance grows with the vector size
+    double tolerance(std::size_t _size) {
+        return 1e-5 * static_cast<double>(_size + 1);
+    }
+
+    void testArithmetic(const w2v::vectorKernels_t &_reference, const w2v::vectorKernels_t &_kernels,
+                        std::size_t _size) {
+        auto x = randomVector(_size);
+        auto w = randomVector(_size);
+        auto err = randomVector(_size);
+        W2V_CHECK_NEAR(_kernels.dot(x.data(), w.data(), _size), _reference.dot(x.data(), w.data(), _size),
+                       tolerance(_size));
+
+        auto referenceErr = err;
+        auto referenceW = w;
+        _reference.update(referenceErr.data(), referenceW.data(), x.data(), 0.3f, _size);
+        _kernels.update(err.data(), w.data(), x.data(), 0.3f, _size);
+        for (std::size_t i = 0; i < _size; ++i) {
+            W2V_CHECK_NEAR(err[i], referenceErr[i], 1e-5);
+            W2V_CHECK_NEAR(w[i], referenceW[i], 1e-5);
+        }
+
+        // window contexts by target words, shapes of the batched Skip-Gram
+        static const std::size_t shapes[][2] = {{1, 1}, {3, 5}, {4, 6}, {10, 6}, {7, 26}};
+        for (auto const &shape:shapes) {
+            const auto m = shape[0];
+            const auto n = shape[1];
+            auto a = randomVector(m * _size);
+            auto b = randomVector(n * _size);
+            std::vector<float> c(m * n);
+            std::vector<float> referenceC(m * n);
+            _reference.gemmNT(a.data(), b.data(), referenceC.data(), m, n, _size);
+            _kernels.gemmNT(a.data(), b.data(), c.data(), m, n, _size);
+            for (std::size_t i = 0; i < m * n; ++i) {
+                W2V_CHECK_NEAR(c[i], referenceC[i], tolerance(_size));
+            }
+
+            auto g = randomVector(m * n);
+            std::vector<float> d(m * _size);
+            std::vector<float> referenceD(m * _size);
+            _reference.gemmNN(g.data(), b.data(), referenceD.data(), m, n, _size);
+            _kernels.gemmNN(g.data(), b.data(), d.data(), m, n, _size);
+            for (std::size_t i = 0; i < m * _size; ++i) {
+                W2V_CHECK_NEAR(d[i], referenceD[i], tolerance(n));
+            }
+        }
+    }
+
+    // values of all magnitudes representable by fp16, including subnormals and zeros
+    std::vector<float> codecValues(std::size_t _size) {
+        std::uniform_real_distribution<float> exponent(-24.0f, 15.0f);
+        auto ret = randomVector(_size);
+        for (std::size_t i = 0; i < _size; ++i) {
+            ret[i] = (i % 13 == 0) ? 0.0f : ret[i] * std::exp2(exponent(randomGenerator));
+        }
+        return ret;
+    }
+
+    void testCodec(w2v::vectorKernels_t::load16_t _referenceLoad, w2v::vectorKernels_t::store16_t _referenceStore,
+                   w2v::vectorKernels_t::load16_t _load, w2v::vectorKernels_t::store16_t _store,
+                   float _epsilon, float _minNormal, std::size_t _size) {
+        auto values = codecValues(_size);
+        std::vector<uint32_t> noise(_size);
+        for (auto &i:noise) {
+            i = static_cast<uint32_t>(randomGenerator());
+        }
+
+        std::vector<uint16_t> referenceBits(_size);
+        std::vector<uint16_t> bits(_size);
+        _referenceStore(referenceBits.data(), values.data(), noise.data(), _size);
+        _store(bits.data(), values.data(), noise.data(), _size);
+        std::vector<float> restored(_size);
+        _load(bits.data(), restored.data(), _size);
+        std::vector<float> referenceRestored(_size);
+        _referenceLoad(referenceBits.data(), referenceRestored.data(), _size);
+        for (std::size_t i = 0; i < _size; ++i) {
+            // the same noise gives the same rounding
+            W2V_CHECK(bits[i] == referenceBits[i]);
+            W2V_CHECK(restored[i] == referenceRestored[i]);
+            // stochastic rounding error is less than one unit of the last kept bit
+            const auto magnitude = std::max(std::fabs(values[i]), _minNormal);
+            W2V_CHECK_NEAR(restored[i], values[i], magnitude * _epsilon);
+        }
+    }
+}
+
+int main() {
+    static const std::size_t sizes[] = {50, 100, 128, 200, 256, 300, 500, 1, 7, 15, 17, 33};
+    for (auto size:sizes) {
+        const auto kernels = w2v::vectorKernels_t::supported(static_cast<uint16_t>(size));
+        W2V_CHECK(!kernels.empty());
+        W2V_CHECK(kernels.back().name == w2v::vectorKernels_t::instance(static_cast<uint16_t>(size)).name);
+        const auto &reference = kernels.front();
+        for (auto const &i:kernels) {
+            std::cout << "size " << size << ", " << i.name << std::endl;
+            testArithmetic(reference, i, size);
+            testCodec(reference.loadBF16, reference.storeBF16, i.loadBF16, i.storeBF16,
+                      1.0f / 128.0f, 0.0f, size);
+            testCodec(reference.loadFP16, reference.storeFP16, i.loadFP16, i.storeFP16,
+                      1.0f / 1024.0f, 6.103515625e-05f, size);
+        }
+    }
+
+    return w2v::test::result();
+}
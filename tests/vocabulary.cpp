@@ -0,0 +1,129 @@
+/**
+ * @file
+ * @brief vocabulary test - frequency pruning and parallel counting of the words
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "corpus.hpp"
+#include "trainChunks.hpp"
+#include "vocabulary.hpp"
+#include "test.hpp"
+
+namespace {
+    void testReduce() {
+        // words "1".."10", the frequency of each word is its number
+        std::unordered_map<std::string, std::size_t> words;
+        for (std::size_t i = 1; i <= 10; ++i) {
+            words[std::to_string(i)] = i;
+        }
+
+        // nothing is removed while the limit is not exceeded
+        std::size_t threshold = 1;
+        W2V_CHECK(w2v::vocabulary_t::reduce(words, 10, threshold) == 0);
+        W2V_CHECK(threshold == 1);
+        W2V_CHECK(words.size() == 10);
+
+        // words of frequencies 1, 2, 3 and 4 are removed one pass after another, the threshold rises each pass
+        W2V_CHECK(w2v::vocabulary_t::reduce(words, 6, threshold) == 1 + 2 + 3 + 4);
+        W2V_CHECK(threshold == 5);
+        W2V_CHECK(words.size() == 6);
+        W2V_CHECK(words.count("4") == 0);
+        W2V_CHECK(words.count("5") == 1);
+
+        // the threshold is kept between calls, so a new word rarer than the threshold is removed at once together
+        // with the words of the threshold frequency
+        words["new"] = 2;
+        words["newer"] = 7;
+        W2V_CHECK(w2v::vocabulary_t::reduce(words, 6, threshold) == 2 + 5);
+        W2V_CHECK(threshold == 6);
+        W2V_CHECK(words.size() == 6);
+        W2V_CHECK(words.count("new") == 0);
+        W2V_CHECK(words.count("5") == 0);
+        W2V_CHECK(words.count("newer") == 1);
+    }
+
+    void testPrunedWords() {
+        const auto corpusFile = w2v::test::tmpFile("vocabulary.txt");
+        std::size_t totalWords = 0;
+        {
+            // 10 frequent words and 2000 distinct rare words
+            std::ofstream corpus(corpusFile, std::ios::trunc);
+            for (std::size_t i = 0; i < 2000; ++i) {
+                corpus << "w" << i % 10 << " w" << (i + 3) % 10 << " rare" << i << "\n";
+                totalWords += 3;
+            }
+        }
+        std::shared_ptr<w2v::corpus_t> corpus(new w2v::corpus_t({corpusFile}));
+        const std::string wordDelimiterChars = " \n";
+        const std::string endOfSentenceChars = "\n";
+
+        for (uint8_t threads = 1; threads <= 4; threads += 3) {
+            const w2v::vocabulary_t unlimited(corpus, nullptr, wordDelimiterChars, endOfSentenceChars,
+                                              1, threads, 1, 0, nullptr);
+            W2V_CHECK(unlimited.prunedWords() == 0);
+            W2V_CHECK(unlimited.totalWords() == totalWords);
+            W2V_CHECK(unlimited.size() == 2010 + 1);
+
+            const w2v::vocabulary_t pruned(corpus, nullptr, wordDelimiterChars, endOfSentenceChars,
+                                           1, threads, 1, 100, nullptr);
+            // rare words are pruned, the frequent words are kept, every word is either kept or pruned
+            W2V_CHECK(pruned.prunedWords() > 0);
+            W2V_CHECK(pruned.size() <= 100 + 1);
+            W2V_CHECK(pruned.totalWords() == totalWords);
+            W2V_CHECK(pruned.trainWords() + pruned.prunedWords() == totalWords);
+            for (std::size_t i = 0; i < 10; ++i) {
+                auto wordData = pruned.data("w" + std::to_string(i));
+                W2V_CHECK((wordData != nullptr) && (wordData->frequency == 400));
+            }
+        }
+
+        std::remove(corpusFile.c_str());
+    }
+
+    void testOneCharChunk() {
+        // the file starts with an end of sentence char, so the first chunk is this char only
+        const auto corpusFile = w2v::test::tmpFile("one_char_chunk.txt");
+        {
+            std::ofstream corpus(corpusFile, std::ios::trunc);
+            corpus << "\nalpha beta\ngamma delta\n";
+        }
+        std::shared_ptr<w2v::corpus_t> corpus(new w2v::corpus_t({corpusFile}));
+        const std::string wordDelimiterChars = " \n";
+        const std::string endOfSentenceChars = "\n";
+
+        const w2v::delimiterScanner_t scanner(wordDelimiterChars, endOfSentenceChars);
+        const w2v::trainChunks_t chunks(*corpus, scanner, 64, 1);
+        W2V_CHECK(chunks.size() > 1);
+        W2V_CHECK(chunks.bound(0) == 0);
+        W2V_CHECK(chunks.bound(1) == 1);
+
+        // the one char chunk must not be read up to the end of the file, so no word is counted twice
+        for (uint8_t threads = 1; threads <= 4; ++threads) {
+            const w2v::vocabulary_t vocabulary(corpus, nullptr, wordDelimiterChars, endOfSentenceChars,
+                                               1, threads, 1, 0, nullptr);
+            W2V_CHECK(vocabulary.totalWords() == 4);
+            W2V_CHECK(vocabulary.size() == 4 + 1);
+            for (const auto &word:{"alpha", "beta", "gamma", "delta"}) {
+                auto wordData = vocabulary.data(word);
+                W2V_CHECK((wordData != nullptr) && (wordData->frequency == 1));
+            }
+        }
+
+        std::remove(corpusFile.c_str());
+    }
+}
+
+int main() {
+    testReduce();
+    testPrunedWords();
+    testOneCharChunk();
+
+    return w2v::test::result();
+}
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief wordReader test - delimiter chars search implementations are compared with the generic one
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "wordReader.hpp"
+#include "test.hpp"
+
+namespace {
+    const std::string wordDelimiterChars = " \n,.-!?:;/\"#$%&'()*+<=>@[]\\^_`{|}~\t\v\f\r\x80\xff";
+
+    // every implementation must return the same position as the generic one
+    void checkFind(const w2v::delimiterScanner_t &_scanner,
+                   const std::vector<w2v::delimiterScanner_t::findImpl_t> &_implementations,
+                   const char *_from, const char *_to) {
+        const char *expected = _implementations.front()(_scanner, _from, _to);
+        for (auto impl:_implementations) {
+            W2V_CHECK(impl(_scanner, _from, _to) == expected);
+        }
+    }
+
+    void testDelimiterScanner() {
+        const auto implementations = w2v::delimiterScanner_t::implementations();
+        W2V_CHECK(!implementations.empty());
+
+        // every byte value at every position of three 32-byte blocks, searched from every offset of the first
+        // block, so the byte is met at every position of 16 and 32 byte vectors and in the scalar tail
+        {
+            const w2v::delimiterScanner_t scanner(wordDelimiterChars, "\n");
+            std::vector<char> buffer(96, 'a');
+            for (std::size_t ch = 0; ch < 256; ++ch) {
+                for (std::size_t pos = 0; pos < buffer.size(); ++pos) {
+                    buffer[pos] = static_cast<char>(ch);
+                    for (std::size_t from = 0; from < 32; ++from) {
+                        checkFind(scanner, implementations, buffer.data() + from, buffer.data() + buffer.size());
+                        // the end of the range before and right after the byte
+                        if (pos >= from) {
+                            checkFind(scanner, implementations, buffer.data() + from, buffer.data() + pos);
+                            checkFind(scanner, implementations, buffer.data() + from, buffer.data() + pos + 1);
+                        }
+                    }
+                    buffer[pos] = 'a';
+                }
+            }
+        }
+
+        // every byte value as the only delimiter, all other byte values are not delimiters
+        for (std::size_t delimiter = 0; delimiter < 256; ++delimiter) {
+            const w2v::delimiterScanner_t scanner(std::string(1, static_cast<char>(delimiter)), "");
+            std::vector<char> buffer;
+            for (std::size_t ch = 0; ch < 256; ++ch) {
+                if (ch != delimiter) {
+                    buffer.push_back(static_cast<char>(ch));
+                }
+            }
+            const char *to = buffer.data() + buffer.size();
+            W2V_CHECK(implementations.front()(scanner, buffer.data(), to) == to);
+            checkFind(scanner, implementations, buffer.data(), to);
+            for (std::size_t pos = 0; pos < 64; ++pos) {
+                const char saved = buffer[pos];
+                buffer[pos] = static_cast<char>(delimiter);
+                W2V_CHECK(implementations.front()(scanner, buffer.data(), to) == buffer.data() + pos);
+                checkFind(scanner, implementations, buffer.data(), to);
+                buffer[pos] = saved;
+            }
+        }
+    }
+}
+
+int main() {
+    testDelimiterScanner();
+
+    return w2v::test::result();
+}
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief training throughput benchmark - trains the same model with 1 to N threads and reports the scaling
+ * @date 17.10.2026
+ * @copyright Apache License v.2 (http://www.apache.org/licenses/LICENSE-2.0)
+*/
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "word2vec.hpp"
+
+static void usage(const char *_name) {
+    std::cout
+            << _name << " [options]" << std::endl
+            << "Options:" << std::endl
+            << "  -f, --train-file <file>" << std::endl
+            << "\tUse text data from <file> to train the model" << std::endl
+            << "  -t, --threads <value>" << std::endl
+            << "\tMax number of threads; models are trained with 1, 2, 4, ... threads up to <value>;" << std::endl
+            << "\tdefault is 12" << std::endl
+            << "  -s, --size <value>" << std::endl
+            << "\tSet size of word vectors; default is 100" << std::endl
+            << "  -i, --iter <value>" << std::endl
+            << "\tRun more training iterations (default 5)" << std::endl
+            << "  -P, --prefetch-distance <value>" << std::endl
+            << "\tPrefetch matrix rows of words <value> positions ahead; default is 2" << std::endl
+            << "  -h, --with-hs" << std::endl
+            << "\tUse Hierarchical Softmax instead of default Negative Sampling" << std::endl
+            << "  -g, --with-skip-gram" << std::endl
+            << "\tUse skip-gram model instead of the default continuous bag of words model" << std::endl
+            << "  -b, --with-batched-sg" << std::endl
+            << "\tUse batched skip-gram, requires skip-gram and negative sampling" << std::endl;
+}
+
+static struct option longopts[] = {
+        {"train-file",      required_argument,  nullptr,   'f' },
+        {"threads",         required_argument,  nullptr,   't' },
+        {"size",            required_argument,  nullptr,   's' },
+        {"iter",            required_argument,  nullptr,   'i' },
+        {"prefetch-distance", required_argument, nullptr,  'P' },
+        {"with-hs",         no_argument,        nullptr,   'h' },
+        {"with-skip-gram",  no_argument,        nullptr,   'g' },
+        {"with-batched-sg", no_argument,        nullptr,   'b' },
+        { nullptr, 0, nullptr, 0 }
+};
+
+int main(int argc, char * const *argv) {
+    std::string trainFile;
+    uint8_t maxThreads = 12;
+    w2v::trainSettings_t trainSettings;
+
+    int ch = 0;
+    while ((ch = getopt_long(argc, argv, "f:t:s:i:P:hgb?", longopts, nullptr)) != -1) {
+        switch (ch) {
+            case 'f':
+                trainFile = optarg;
+                break;
+            case 't':
+                maxThreads = static_cast<uint8_t>(std::stoi(optarg));
+                break;
+            case 's':
+                trainSettings.size = static_cast<uint16_t>(std::stoi(optarg));
+                break;
+            case 'i':
+                trainSettings.iterations = static_cast<uint8_t>(std::stoi(optarg));
+                break;
+            case 'P':
+                trainSettings.prefetchDistance = static_cast<uint8_t>(std::stoi(optarg));
+                break;
+            case 'h':
+                trainSettings.withHS = true;
+                break;
+            case 'g':
+                trainSettings.withSG = true;
+                break;
+            case 'b':
+                trainSettings.withBatchedSG = true;
+                break;
+            case ':':
+            case '?':
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (trainFile.empty() || (maxThreads == 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::cout << "Prefetch distance: " << static_cast<int>(trainSettings.prefetchDistance) << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "seconds"
+              << std::setw(16) << "words/sec" << std::setw(10) << "speedup" << std::endl;
+
+    double baseRate = 0.0;
+    for (unsigned int threads = 1;; threads = std::min(threads * 2, static_cast<unsigned int>(maxThreads))) {
+        trainSettings.threads = static_cast<uint8_t>(threads);
+
+        // only training is measured, vocabulary building is finished when the vocabulary stats are reported
+        std::chrono::steady_clock::time_point start;
+        std::size_t trainWords = 0;
+        w2v::w2vModel_t model;
+        bool trained = model.train(trainSettings, trainFile, std::string(), nullptr,
+                                   [&start, &trainWords] (std::size_t, std::size_t _trainWords, std::size_t) {
+                                       trainWords = _trainWords;
+                                       start = std::chrono::steady_clock::now();
+                                   },
+                                   nullptr);
+        auto stop = std::chrono::steady_clock::now();
+        if (!trained) {
+            std::cerr << "Training failed: " << model.errMsg() << std::endl;
+            return 2;
+        }
+
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        double rate = static_cast<double>(trainWords) * trainSettings.iterations / seconds;
+        if (threads == 1) {
+            baseRate = rate;
+        }
+        std::cout << std::setw(8) << threads
+                  << std::setw(12) << std::fixed << std::setprecision(2) << seconds
+                  << std::setw(16) << std::fixed << std::setprecision(0) << rate
+                  << std::setw(10) << std::fixed << std::setprecision(2) << rate / baseRate << std::endl;
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+
+    return 0;
+}
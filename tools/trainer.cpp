@@ -10,6 +10,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
+#include <vector>
 
 #include "word2vec.hpp"
 
@@ -18,7 +20,11 @@ static void usage(const char *_name) {
             << _name << " [options]" << std::endl
             << "Options:" << std::endl
             << "  -f, --train-file <file>" << std::endl
-            << "\tUse text data from <file> to train the model" << std::endl
+            << "\tUse text data from <file> to train the model; <file> may be a directory, all its files are used," << std::endl
+            << "\tor \"-\" for the standard input, which is read into memory and limited to 4GB;" << std::endl
+            << "\tthe option may be repeated to train on many files;" << std::endl
+            << "\tgzip compressed files are decompressed on the fly into the corpus cache file, or into a" << std::endl
+            << "\ttemporary one in $TMPDIR if the cache file is not set" << std::endl
             << "  -o, --model-file <name>" << std::endl
             << "\tUse <file> to save the resulting word vectors" << std::endl
             << "  -x, --stop-words-file <name>" << std::endl
@@ -40,10 +46,54 @@ static void usage(const char *_name) {
             << "\tRun more training iterations (default 5)" << std::endl
             << "  -m, --min-word-freq <value>" << std::endl
             << "\tThis will discard words that appear less than <int> times; default is 5" << std::endl
+            << "  -u, --max-distinct-words <value>" << std::endl
+            << "\tLimit distinct words while building the vocabulary; the rarest words are pruned with a rising" << std::endl
+            << "\tfrequency threshold when the limit is exceeded; default is 0 - no limit" << std::endl
             << "  -a, --alpha <value>" << std::endl
             << "\tSet the starting learning rate; default is 0.05" << std::endl
             << "  -g, --with-skip-gram" << std::endl
             << "\tUse skip-gram model instead of the default continuous bag of words model" << std::endl
+            << "  -b, --with-batched-sg" << std::endl
+            << "\tUse skip-gram with negative examples shared within a window and trained as matrix products;" << std::endl
+            << "\tscales better with many threads, requires skip-gram and negative sampling; default is false" << std::endl
+            << "  -c, --corpus-cache <file>" << std::endl
+            << "\tParse the train data once into the pre-tokenized <file> and train all iterations from it;" << std::endl
+            << "\tthe file is reused by the next runs with the same train data and vocabulary settings" << std::endl
+            << "  -D, --decompression-threads <value>" << std::endl
+            << "\tUse <int> threads to decompress gzip compressed train data files (default 4)" << std::endl
+            << "  -r, --seed <value>" << std::endl
+            << "\tSet the random generators seed to make training reproducible with a single thread;" << std::endl
+            << "\tdefault is 0 - nondeterministic seed" << std::endl
+            << "  -p, --precision <fp32|bf16|fp16>" << std::endl
+            << "\tStore the training matrices as 32-bit floats or as 16-bit bf16/fp16 values to halve their memory;" << std::endl
+            << "\tcomputations are done with 32-bit floats; default is fp32" << std::endl
+            << "  -k, --cpu-affinity <list>" << std::endl
+            << "\tPin train threads to the CPUs of the <list>, like 0-7,16-23; the i-th thread runs on the" << std::endl
+            << "\ti-th CPU of the list; matrices are initialized by threads pinned the same way; default is no pinning" << std::endl
+            << "  -q, --numa-interleave" << std::endl
+            << "\tInterleave matrices memory over all NUMA nodes instead of the first-touch placement" << std::endl
+            << "  -L, --no-huge-pages" << std::endl
+            << "\tDo not allocate matrices on huge pages; default is huge pages if the system provides them" << std::endl
+            << "  -j, --hot-rows <value>" << std::endl
+            << "\tEach thread trains its own copies of the <value> most used output rows and merges them into" << std::endl
+            << "\tthe shared matrix periodically; default is 0 - disabled" << std::endl
+            << "  -J, --hot-input-rows" << std::endl
+            << "\tKeep private copies of the most frequent words input rows as well; default is false" << std::endl
+            << "  -z, --hot-rows-sync <value>" << std::endl
+            << "\tMerge private rows after each <value> words processed by a thread; default is 1000" << std::endl
+            << "  -P, --prefetch-distance <value>" << std::endl
+            << "\tPrefetch matrix rows of words <value> positions ahead and of their negative examples;" << std::endl
+            << "\t0 disables prefetching; default is 2" << std::endl
+            << "  -C, --checkpoint <file>" << std::endl
+            << "\tSave the training state to <file> periodically, so an interrupted training can be resumed" << std::endl
+            << "  -I, --checkpoint-interval <value>" << std::endl
+            << "\tSave checkpoints every <value> seconds; default is 1800" << std::endl
+            << "  -R, --resume <file>" << std::endl
+            << "\tResume the training from the checkpoint <file> with the same train data; model parameters are" << std::endl
+            << "\trestored from the checkpoint, threads and memory options are taken from the command line" << std::endl
+            << "  -U, --update <file>" << std::endl
+            << "\tUpdate the model trained with -C <file> with new train data: new words are added, only the new" << std::endl
+            << "\tdata is trained; vector size, precision and -h are restored from the model" << std::endl
             << "  -d, --word-delimiter <chars>" << std::endl
             << "\tSet the word delimiter chars; default is \" \\n,.-!?:;/\\\"#$%&'()*+<=>@[]\\\\^_`{|}~\\t\\v\\f\\r\"" << std::endl
             << "  -e, --end-of-sentence <chars>" << std::endl
@@ -52,6 +102,34 @@ static void usage(const char *_name) {
             << "\tShow training process details; default is false" << std::endl;
 }
 
+// parses CPU list like "0-7,16-23"
+static bool parseCpuList(const std::string &_list, std::vector<uint16_t> &_cpus) {
+    _cpus.clear();
+    std::size_t pos = 0;
+    while (pos < _list.size()) {
+        auto end = _list.find(',', pos);
+        if (end == std::string::npos) {
+            end = _list.size();
+        }
+        auto range = _list.substr(pos, end - pos);
+        auto dash = range.find('-');
+        try {
+            auto from = std::stoul(range.substr(0, dash));
+            auto to = (dash == std::string::npos) ? from : std::stoul(range.substr(dash + 1));
+            if ((from > to) || (to > 65535)) {
+                return false;
+            }
+            for (auto i = from; i <= to; ++i) {
+                _cpus.push_back(static_cast<uint16_t>(i));
+            }
+        } catch (...) {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return !_cpus.empty();
+}
+
 static struct option longopts[] = {
         {"train-file",      required_argument,  nullptr,   'f' },
         {"model-file",      required_argument,  nullptr,   'o' },
@@ -64,8 +142,25 @@ static struct option longopts[] = {
         {"threads",         required_argument,  nullptr,   't' },
         {"iter",            required_argument,  nullptr,   'i' },
         {"min-word-freq",   required_argument,  nullptr,   'm' },
+        {"max-distinct-words", required_argument, nullptr, 'u' },
         {"alpha",           required_argument,  nullptr,   'a' },
         {"with-skip-gram",  no_argument,        nullptr,   'g' },
+        {"with-batched-sg", no_argument,        nullptr,   'b' },
+        {"corpus-cache",    required_argument,  nullptr,   'c' },
+        {"decompression-threads", required_argument, nullptr, 'D' },
+        {"seed",            required_argument,  nullptr,   'r' },
+        {"precision",       required_argument,  nullptr,   'p' },
+        {"cpu-affinity",    required_argument,  nullptr,   'k' },
+        {"numa-interleave", no_argument,        nullptr,   'q' },
+        {"no-huge-pages",   no_argument,        nullptr,   'L' },
+        {"hot-rows",        required_argument,  nullptr,   'j' },
+        {"hot-input-rows",  no_argument,        nullptr,   'J' },
+        {"hot-rows-sync",   required_argument,  nullptr,   'z' },
+        {"prefetch-distance", required_argument, nullptr,  'P' },
+        {"checkpoint",      required_argument,  nullptr,   'C' },
+        {"checkpoint-interval", required_argument, nullptr, 'I' },
+        {"resume",          required_argument,  nullptr,   'R' },
+        {"update",          required_argument,  nullptr,   'U' },
         {"word-delimiters", required_argument,  nullptr,   'd' },
         {"end-of-sentence", required_argument,  nullptr,   'e' },
         {"verbose",         no_argument,        nullptr,   'v' },
@@ -73,17 +168,19 @@ static struct option longopts[] = {
 };
 
 int main(int argc, char * const *argv) {
-    std::string trainFile;
+    std::vector<std::string> trainFiles;
     std::string modelFile;
     std::string stopWordsFile;
+    std::string resumeFile;
+    std::string updateFile;
     bool verbose = false;
     w2v::trainSettings_t trainSettings;
 
     int ch = 0;
-    while ((ch = getopt_long(argc, argv, "f:o:x:s:w:l:hn:t:i:m:a:gd:e:v?", longopts, nullptr)) != -1) {
+    while ((ch = getopt_long(argc, argv, "f:o:x:s:w:l:hn:t:i:m:u:a:gbc:D:r:p:k:qLj:Jz:P:C:I:R:U:d:e:v?", longopts, nullptr)) != -1) {
         switch (ch) {
             case 'f':
-                trainFile = optarg;
+                trainFiles.emplace_back(optarg);
                 break;
             case 'o':
                 modelFile = optarg;
@@ -115,12 +212,75 @@ int main(int argc, char * const *argv) {
             case 'm':
                 trainSettings.minWordFreq = static_cast<uint16_t>(std::stoi(optarg));
                 break;
+            case 'u':
+                trainSettings.maxDistinctWords = static_cast<std::size_t>(std::stoull(optarg));
+                break;
             case 'a':
                 trainSettings.alpha = std::stof(optarg);
                 break;
             case 'g':
                 trainSettings.withSG = true;
                 break;
+            case 'b':
+                trainSettings.withBatchedSG = true;
+                break;
+            case 'c':
+                trainSettings.corpusCacheFile = optarg;
+                break;
+            case 'D':
+                trainSettings.decompressionThreads = static_cast<uint8_t>(std::stoi(optarg));
+                break;
+            case 'r':
+                trainSettings.seed = std::stoull(optarg);
+                break;
+            case 'p':
+                if (std::string(optarg) == "fp32") {
+                    trainSettings.precision = w2v::matrixPrecision_t::FP32;
+                } else if (std::string(optarg) == "bf16") {
+                    trainSettings.precision = w2v::matrixPrecision_t::BF16;
+                } else if (std::string(optarg) == "fp16") {
+                    trainSettings.precision = w2v::matrixPrecision_t::FP16;
+                } else {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'k':
+                if (!parseCpuList(optarg, trainSettings.cpuAffinity)) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'q':
+                trainSettings.numaInterleave = true;
+                break;
+            case 'L':
+                trainSettings.hugePages = false;
+                break;
+            case 'j':
+                trainSettings.hotRows = static_cast<std::size_t>(std::stoull(optarg));
+                break;
+            case 'J':
+                trainSettings.hotInputRows = true;
+                break;
+            case 'z':
+                trainSettings.hotRowsSyncWords = static_cast<std::size_t>(std::stoull(optarg));
+                break;
+            case 'P':
+                trainSettings.prefetchDistance = static_cast<uint8_t>(std::stoi(optarg));
+                break;
+            case 'C':
+                trainSettings.checkpointFile = optarg;
+                break;
+            case 'I':
+                trainSettings.checkpointInterval = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'R':
+                resumeFile = optarg;
+                break;
+            case 'U':
+                updateFile = optarg;
+                break;
             case 'd':
                 trainSettings.wordDelimiterChars = optarg;
                 break;
@@ -138,16 +298,37 @@ int main(int argc, char * const *argv) {
         }
     }
 
-    if (trainFile.empty() || modelFile.empty()) {
+    if (trainFiles.empty() || modelFile.empty() || (!resumeFile.empty() && !updateFile.empty())) {
         usage(argv[0]);
         return 1;
     }
 
     if (verbose) {
-        std::cout << "Train data file: " << trainFile << std::endl;
+        std::cout << "Train data:";
+        for (auto const &i:trainFiles) {
+            std::cout << " " << i;
+        }
+        std::cout << std::endl;
         std::cout << "Output model file: " << modelFile << std::endl;
         std::cout << "Stop-words file: " << stopWordsFile << std::endl;
-        std::cout << "Training model: " << (trainSettings.withSG?"Skip-Gram":"CBOW") << std::endl;
+        if (!resumeFile.empty()) {
+            std::cout << "Resumed from checkpoint: " << resumeFile
+                      << " (model parameters are restored from the checkpoint)" << std::endl;
+        }
+        if (!updateFile.empty()) {
+            std::cout << "Updated model: " << updateFile << std::endl;
+        }
+        if (!trainSettings.checkpointFile.empty()) {
+            std::cout << "Checkpoint file: " << trainSettings.checkpointFile
+                      << ", saved every " << trainSettings.checkpointInterval << " seconds" << std::endl;
+        }
+        if (!trainSettings.corpusCacheFile.empty()) {
+            std::cout << "Corpus cache file: " << trainSettings.corpusCacheFile << std::endl;
+        }
+        std::cout << "Number of decompression threads: " << static_cast<int>(trainSettings.decompressionThreads)
+                  << std::endl;
+        std::cout << "Training model: " << (trainSettings.withSG?"Skip-Gram":"CBOW")
+                  << (trainSettings.withBatchedSG?" (batched)":"") << std::endl;
         std::cout << "Sample approximation method: ";
         if (trainSettings.withHS) {
             std::cout << "Hierarchical softmax" << std::endl;
@@ -158,43 +339,93 @@ int main(int argc, char * const *argv) {
         std::cout << "Number of training threads: " << static_cast<int>(trainSettings.threads) << std::endl;
         std::cout << "Number of training iterations: " << static_cast<int>(trainSettings.iterations) << std::endl;
         std::cout << "Min word frequency: " << static_cast<int>(trainSettings.minWordFreq) << std::endl;
+        if (trainSettings.maxDistinctWords > 0) {
+            std::cout << "Max distinct words: " << trainSettings.maxDistinctWords << std::endl;
+        }
         std::cout << "Vector size: " << static_cast<int>(trainSettings.size) << std::endl;
+        if (trainSettings.precision != w2v::matrixPrecision_t::FP32) {
+            std::cout << "Training matrices precision: "
+                      << ((trainSettings.precision == w2v::matrixPrecision_t::BF16)?"bf16":"fp16") << std::endl;
+        }
         std::cout << "Max skip length: " << static_cast<int>(trainSettings.window) << std::endl;
+        std::cout << "Prefetch distance: " << static_cast<int>(trainSettings.prefetchDistance) << std::endl;
         std::cout << "Threshold for occurrence of words: " << trainSettings.sample << std::endl;
         std::cout << "Starting learning rate: " << trainSettings.alpha << std::endl;
+        if (trainSettings.seed != 0) {
+            std::cout << "Random seed: " << trainSettings.seed << std::endl;
+        }
+        if (!trainSettings.cpuAffinity.empty()) {
+            std::cout << "CPU affinity:";
+            for (auto i:trainSettings.cpuAffinity) {
+                std::cout << " " << i;
+            }
+            std::cout << std::endl;
+        }
+        if (trainSettings.numaInterleave) {
+            std::cout << "NUMA placement: interleaved" << std::endl;
+        }
+        if (!trainSettings.hugePages) {
+            std::cout << "Huge pages: disabled" << std::endl;
+        }
+        if (trainSettings.hotRows > 0) {
+            std::cout << "Thread private rows: " << trainSettings.hotRows
+                      << (trainSettings.hotInputRows?" output and input":" output")
+                      << ", merged every " << trainSettings.hotRowsSyncWords << " words" << std::endl;
+        }
         std::cout << std::endl << std::flush;
     }
 
     w2v::w2vModel_t model;
+    // a new, a resumed and an updated training report their progress the same way
+    w2v::w2vModel_t::vocabularyProgressCallback_t vocabularyProgress = nullptr;
+    w2v::w2vModel_t::vocabularyStatsCallback_t vocabularyStats = nullptr;
+    w2v::w2vModel_t::trainProgressCallback_t trainProgress = nullptr;
+    w2v::w2vModel_t::numaStatsCallback_t numaStats = nullptr;
+    if (verbose) {
+        trainProgress = [] (float _alpha, float _percent) {
+            std::cout << '\r'
+                      << "alpha: "
+                      << std::fixed << std::setprecision(6)
+                      << _alpha
+                      << ", progress: "
+                      << std::fixed << std::setprecision(2)
+                      << _percent << "%"
+                      << std::flush;
+        };
+        numaStats = [] (std::size_t _node, std::size_t _threads, std::size_t _pages) {
+            std::cout << "NUMA node " << _node << ": "
+                      << _threads << " pinned train threads, "
+                      << _pages << " matrices pages" << std::endl;
+        };
+        vocabularyProgress = [] (float _percent) {
+            std::cout << "\rParsing train data... "
+                      << std::fixed << std::setprecision(2)
+                      << _percent << "%" << std::flush;
+        };
+        vocabularyStats = [&model] (std::size_t _vocWords, std::size_t _trainWords, std::size_t _totalWords) {
+            std::cout << std::endl
+                      << "Vocabulary size: " << _vocWords << std::endl
+                      << "Train words: " << _trainWords << std::endl
+                      << "Total words: " << _totalWords << std::endl;
+            if (model.prunedWords() > 0) {
+                std::cout << "Pruned words: " << model.prunedWords() << std::endl;
+            }
+            std::cout << std::endl;
+        };
+    }
+
     bool trained;
+    if (!resumeFile.empty()) {
+        trained = model.resume(trainSettings, trainFiles, resumeFile, trainProgress, numaStats);
+    } else if (!updateFile.empty()) {
+        trained = model.update(trainSettings, trainFiles, stopWordsFile, updateFile,
+                               vocabularyProgress, vocabularyStats, trainProgress, numaStats);
+    } else {
+        trained = model.train(trainSettings, trainFiles, stopWordsFile,
+                              vocabularyProgress, vocabularyStats, trainProgress, numaStats);
+    }
     if (verbose) {
-        trained = model.train(trainSettings, trainFile, stopWordsFile,
-                              [] (float _percent) {
-                                  std::cout << "\rParsing train data... "
-                                            << std::fixed << std::setprecision(2)
-                                            << _percent << "%" << std::flush;
-                              },
-                              [] (std::size_t _vocWords, std::size_t _trainWords, std::size_t _totalWords) {
-                                  std::cout << std::endl
-                                            << "Vocabulary size: " << _vocWords << std::endl
-                                            << "Train words: " << _trainWords << std::endl
-                                            << "Total words: " << _totalWords << std::endl
-                                            << std::endl;
-                              },
-                              [] (float _alpha, float _percent) {
-                                  std::cout << '\r'
-                                            << "alpha: "
-                                            << std::fixed << std::setprecision(6)
-                                            << _alpha
-                                            << ", progress: "
-                                            << std::fixed << std::setprecision(2)
-                                            << _percent << "%"
-                                            << std::flush;
-                              }
-        );
         std::cout << std::endl;
-    } else {
-        trained = model.train(trainSettings, trainFile, stopWordsFile, nullptr, nullptr, nullptr);
     }
     if (!trained) {
         std::cerr << "Training failed: " << model.errMsg() << std::endl;